@@ -0,0 +1,222 @@
+/*
+  Checks `add_bank_word` and `remove_bank_word` against a bank loaded afresh.
+  It loads some of the words of a bank, searches every verdict group of a
+  guess, then adds a target and a guess, removes a target and a guess, and
+  checks:
+    - that words already in the bank, or of the wrong size, are not added,
+      and that words not in the bank are not removed;
+    - that the words, the hash and every verdict match those of a bank loaded
+      with the same words;
+    - that every group left unchanged by the update is answered from the
+      cache, without a search;
+    - that every group, changed or not, costs what a search on the fresh bank
+      finds.
+  Prints a summary and exits with 1 if any check fails.
+
+  Flags (each followed by a value):
+    --bank-root    directory holding the banks (default `../../bank`)
+    --bank         bank the words are taken from (default `co_wordle`)
+    --words        number of targets, and of other guesses, taken from it
+                   (default 300)
+    --guess        guess whose verdict groups are searched (default `LEAST`)
+*/
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../bot.hh"
+#include "../cli.hh"
+
+/* The words of `list`, as sorted strings, targets first */
+std::vector<std::string> list_word_strings(const wordy_witch::word_bank& bank,
+                                           wordy_witch::word_list_view list) {
+  std::vector<std::string> words;
+  for (int i = 0; i < list.num_words; i++) {
+    words.push_back(bank.words[list.words[i]]);
+  }
+  std::sort(words.begin(), words.begin() + list.num_targets);
+  std::sort(words.begin() + list.num_targets, words.end());
+  return words;
+}
+
+/* Returns an error message if some check fails (see the top of this file) */
+std::optional<std::string> check_bank_updates(
+    const std::vector<std::string>& targets,
+    const std::vector<std::string>& guesses, const std::string& guess_word) {
+  if (targets.size() < 2 || guesses.size() < 2) {
+    return "too few words";
+  }
+  /* The last target and guess are added later; the first ones removed. */
+  std::vector<std::string> words(targets.begin(), targets.end() - 1);
+  words.insert(words.end(), guesses.begin(), guesses.end() - 1);
+  static wordy_witch::word_bank bank;
+  if (!wordy_witch::load_bank(bank, words, targets.size() - 1)) {
+    return "the words were not loaded";
+  }
+  std::optional<int> guess = wordy_witch::find_word(bank, guess_word);
+  if (!guess.has_value()) {
+    return "unknown guess " + guess_word;
+  }
+
+  static wordy_witch::bot_cache bot_cache = {};
+  static wordy_witch::verdict_groups groups;
+  std::map<int, std::vector<std::string>> words_by_verdict;
+  wordy_witch::group_remaining_words(groups, bank, bank.all_words,
+                                     guess.value());
+  for (int verdict = 0; verdict < wordy_witch::word_bank::NUM_VERDICTS;
+       verdict++) {
+    if (groups[verdict].num_targets >= 3) {
+      words_by_verdict[verdict] = list_word_strings(bank, groups[verdict]);
+      wordy_witch::find_best_guess(bank, bot_cache,
+                                   wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED, 1,
+                                   groups[verdict]);
+    }
+  }
+
+  if (wordy_witch::add_bank_word(bank, targets[0], true).has_value() ||
+      wordy_witch::add_bank_word(bank, targets.back() + "S", true)
+          .has_value()) {
+    return "a word in the bank, or of the wrong size, was added";
+  }
+  int first_target = bank.all_words.words[0];
+  int first_guess = bank.all_words.words[bank.all_words.num_targets];
+  if (!wordy_witch::add_bank_word(bank, targets.back(), true).has_value() ||
+      !wordy_witch::add_bank_word(bank, guesses.back(), false).has_value() ||
+      !wordy_witch::remove_bank_word(bank, first_target) ||
+      !wordy_witch::remove_bank_word(bank, first_guess)) {
+    return "the update failed";
+  }
+  if (wordy_witch::remove_bank_word(bank, first_target)) {
+    return "a word not in the bank was removed";
+  }
+
+  std::vector<std::string> updated_words;
+  for (int i = 0; i < bank.all_words.num_words; i++) {
+    updated_words.push_back(bank.words[bank.all_words.words[i]]);
+  }
+  static wordy_witch::word_bank fresh_bank;
+  wordy_witch::load_bank(fresh_bank, updated_words, bank.num_targets);
+  if (bank.num_words != fresh_bank.num_words ||
+      bank.num_targets != fresh_bank.num_targets ||
+      list_word_strings(bank, bank.all_words) !=
+          list_word_strings(fresh_bank, fresh_bank.all_words)) {
+    return "the words differ from a fresh bank";
+  }
+  if (bank.hash != fresh_bank.hash) {
+    return "the hash differs from a fresh bank";
+  }
+  for (int i = 0; i < bank.num_words; i++) {
+    for (int j = 0; j < bank.num_words; j++) {
+      if (bank.verdicts[bank.all_words.words[i]][bank.all_words.words[j]] !=
+          fresh_bank.verdicts[fresh_bank.all_words.words[i]]
+                             [fresh_bank.all_words.words[j]]) {
+        return "the verdict of " + updated_words[i] + " against " +
+               updated_words[j] + " differs from a fresh bank";
+      }
+    }
+  }
+
+  static wordy_witch::bot_cache fresh_bot_cache = {};
+  static wordy_witch::verdict_groups fresh_groups;
+  wordy_witch::group_remaining_words(groups, bank, bank.all_words,
+                                     guess.value());
+  wordy_witch::group_remaining_words(
+      fresh_groups, fresh_bank, fresh_bank.all_words,
+      wordy_witch::find_word(fresh_bank, guess_word).value());
+  int num_groups_reused = 0;
+  int num_groups_changed = 0;
+  for (int verdict = 0; verdict < wordy_witch::word_bank::NUM_VERDICTS;
+       verdict++) {
+    if (groups[verdict].num_targets < 3) {
+      continue;
+    }
+    bool is_unchanged = words_by_verdict.count(verdict) > 0 &&
+                        words_by_verdict[verdict] ==
+                            list_word_strings(bank, groups[verdict]);
+    int64_t num_nodes_searched = bot_cache.stats.num_nodes_searched;
+    wordy_witch::candidate_info best_guess = wordy_witch::find_best_guess(
+        bank, bot_cache, wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED, 1,
+        groups[verdict]);
+    if (is_unchanged) {
+      if (bot_cache.stats.num_nodes_searched != num_nodes_searched) {
+        return "group " + wordy_witch::format_verdict(verdict) +
+               " was searched again";
+      }
+      num_groups_reused++;
+    } else {
+      num_groups_changed++;
+    }
+    wordy_witch::candidate_info fresh_best_guess =
+        wordy_witch::find_best_guess(fresh_bank, fresh_bot_cache,
+                                     wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED, 1,
+                                     fresh_groups[verdict]);
+    if (best_guess.cost != fresh_best_guess.cost) {
+      return "group " + wordy_witch::format_verdict(verdict) + " costs " +
+             std::to_string(best_guess.cost) + " instead of " +
+             std::to_string(fresh_best_guess.cost);
+    }
+  }
+  if (num_groups_reused == 0 || num_groups_changed == 0) {
+    return "the update leaves no group unchanged, or changes none; try "
+           "another --guess";
+  }
+  std::cout << bank.num_words << " words after the update: hash and verdicts "
+            << "match a fresh bank; " << num_groups_reused
+            << " unchanged groups answered from the cache and "
+            << num_groups_changed
+            << " changed ones searched, all at the fresh bank's cost"
+            << std::endl;
+  return std::nullopt;
+}
+
+int main(int argc, char** argv) {
+  std::map<std::string, std::string> flags = {
+      {"--bank-root", "../../bank"},
+      {"--bank", "co_wordle"},
+      {"--words", "300"},
+      {"--guess", "LEAST"},
+  };
+  std::optional<std::string> flag_error =
+      wordy_witch::parse_flags(flags, {}, argc, argv);
+  if (flag_error.has_value()) {
+    std::cerr << flag_error.value() << std::endl;
+    return 1;
+  }
+
+  std::filesystem::path bank_path =
+      std::filesystem::path(flags["--bank-root"]) / flags["--bank"];
+  int num_words = std::stoi(flags["--words"]);
+  std::vector<std::string> targets;
+  wordy_witch::read_words(targets, bank_path / "targets.txt");
+  std::vector<std::string> guesses;
+  wordy_witch::read_words(guesses, bank_path / "common_guesses.txt");
+  targets.resize(std::min<int>(targets.size(), num_words));
+  guesses.resize(std::min<int>(guesses.size(), num_words));
+  if (targets.empty()) {
+    std::cerr << "Cannot load bank " << flags["--bank"] << std::endl;
+    return 1;
+  }
+  for (std::vector<std::string>* list : {&targets, &guesses}) {
+    for (std::string& word : *list) {
+      word = wordy_witch::to_upper(word);
+    }
+  }
+  /* The guess is kept in the bank throughout, away from the updated words. */
+  std::string guess = wordy_witch::to_upper(flags["--guess"]);
+  for (std::vector<std::string>* list : {&targets, &guesses}) {
+    list->erase(std::remove(list->begin(), list->end(), guess), list->end());
+  }
+  guesses.insert(guesses.begin() + std::min<int>(guesses.size(), 1), guess);
+
+  std::optional<std::string> error =
+      check_bank_updates(targets, guesses, guess);
+  if (error.has_value()) {
+    std::cerr << error.value() << std::endl;
+    return 1;
+  }
+}
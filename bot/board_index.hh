@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bot.hh"
+#include "cli.hh"
+
+namespace wordy_witch {
+
+/*
+  Lets board states be resolved without grouping the bank by every guess:
+  words are looked up by hash, and for each guess and verdict the targets
+  showing that verdict are listed in bank order, about 2 bytes per guess and
+  target. The index describes the words of the bank when it was built, so it
+  must be rebuilt after `add_bank_word` or `remove_bank_word`.
+*/
+template <typename bank_type_>
+struct basic_board_index {
+  using bank_type = bank_type_;
+
+  const bank_type* bank;
+  std::unordered_map<std::string, int> words_by_letters;
+  /*
+    The targets with verdict `verdict` for `guess` are `postings` from
+    `posting_starts[guess * (NUM_VERDICTS + 1) + verdict]` up to the start
+    of the next verdict
+  */
+  std::vector<int> posting_starts;
+  std::vector<uint16_t> postings;
+};
+
+using board_index = basic_board_index<word_bank>;
+
+template <typename bank_type>
+void build_board_index(basic_board_index<bank_type>& out_index,
+                       const bank_type& bank) {
+  static_assert(MAX_BANK_SIZE <= 1 << 16, "word ids must fit in postings");
+  constexpr int NUM_VERDICTS = bank_type::NUM_VERDICTS;
+  const word_list& all_words = bank.all_words;
+  out_index.bank = &bank;
+  out_index.words_by_letters.clear();
+  std::vector<bool> is_in_bank(bank.num_ids);
+  for (int i = 0; i < all_words.num_words; i++) {
+    int word = all_words.words[i];
+    out_index.words_by_letters[bank.words[word]] = word;
+    is_in_bank[word] = true;
+  }
+
+  out_index.posting_starts.assign(
+      static_cast<size_t>(bank.num_ids) * (NUM_VERDICTS + 1), 0);
+  out_index.postings.resize(static_cast<size_t>(all_words.num_words) *
+                            all_words.num_targets);
+  int next_start = 0;
+  for (int guess = 0; guess < bank.num_ids; guess++) {
+    int* starts = &out_index.posting_starts[guess * (NUM_VERDICTS + 1)];
+    if (!is_in_bank[guess]) {
+      std::fill_n(starts, NUM_VERDICTS + 1, next_start);
+      continue;
+    }
+    const auto& guess_verdicts = bank.verdicts[guess];
+    for (int i = 0; i < all_words.num_targets; i++) {
+      starts[guess_verdicts[all_words.words[i]] + 1]++;
+    }
+    starts[0] = next_start;
+    for (int verdict = 0; verdict < NUM_VERDICTS; verdict++) {
+      starts[verdict + 1] += starts[verdict];
+    }
+    int next_slots[NUM_VERDICTS];
+    std::copy_n(starts, NUM_VERDICTS, next_slots);
+    for (int i = 0; i < all_words.num_targets; i++) {
+      int target = all_words.words[i];
+      out_index.postings[next_slots[guess_verdicts[target]]++] = target;
+    }
+    next_start = starts[NUM_VERDICTS];
+  }
+}
+
+template <typename bank_type>
+std::optional<int> find_indexed_word(
+    const basic_board_index<bank_type>& index, const std::string& word) {
+  auto it = index.words_by_letters.find(to_upper(word));
+  if (it == index.words_by_letters.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+/*
+  Does what `apply_board_state` does, with the same results and errors. The
+  targets left after the first move are its postings, and every later move
+  keeps those it would list, which a lookup in the verdict table tells. Each
+  other word is then checked once against the hard mode constraints of the
+  moves since it stopped being a target, instead of once per verdict group
+  of every move, and listed in the order `apply_verdict` would leave it.
+*/
+template <typename bank_type>
+std::optional<std::string> resolve_board_state(
+    word_list& out_remaining_words, const basic_board_index<bank_type>& index,
+    const std::vector<std::string>& state) {
+  constexpr int NUM_VERDICTS = bank_type::NUM_VERDICTS;
+  const bank_type& bank = *index.bank;
+  const word_list& all_words = bank.all_words;
+
+  /* Moves up to the first error, which comes after them */
+  std::vector<std::pair<int, int>> moves;
+  std::optional<std::string> parse_error;
+  std::optional<int> guess;
+  for (int i = 0; i < state.size() && !parse_error.has_value(); i++) {
+    if (i % 2 == 0) {
+      guess = find_indexed_word(index, state[i]);
+      if (!guess.has_value()) {
+        parse_error = "unknown word " + state[i];
+      }
+      continue;
+    }
+    std::optional<int> verdict =
+        parse_verdict<bank_type::WORD_SIZE>(state[i]);
+    if (!verdict.has_value()) {
+      parse_error = "invalid verdict " + state[i];
+      continue;
+    }
+    moves.emplace_back(guess.value(), verdict.value());
+  }
+  if (moves.empty()) {
+    list_all_words(out_remaining_words, bank);
+    return parse_error;
+  }
+
+  /* `targets_left[m]` => targets still possible after move `m` */
+  std::vector<std::vector<int>> targets_left(moves.size());
+  for (int m = 0; m < moves.size(); m++) {
+    auto [guess, verdict] = moves[m];
+    if (m == 0) {
+      const int* starts =
+          &index.posting_starts[guess * (NUM_VERDICTS + 1) + verdict];
+      targets_left[m].assign(index.postings.begin() + starts[0],
+                             index.postings.begin() + starts[1]);
+    } else {
+      for (int target : targets_left[m - 1]) {
+        if (bank.verdicts[guess][target] == verdict) {
+          targets_left[m].push_back(target);
+        }
+      }
+    }
+    if (targets_left[m].empty()) {
+      return "no target is left after " + state[m * 2] + " " +
+             state[m * 2 + 1];
+    }
+  }
+
+  using hard_mode_validity_check =
+      decltype(make_hard_mode_validity_check(bank, 0, 0));
+  std::vector<hard_mode_validity_check> hard_mode_validity_checks;
+  for (auto [guess, verdict] : moves) {
+    hard_mode_validity_checks.push_back(
+        make_hard_mode_validity_check(bank, guess, verdict));
+  }
+  auto is_valid_since = [&hard_mode_validity_checks](int first_move,
+                                                     int word) -> bool {
+    for (int m = first_move; m < hard_mode_validity_checks.size(); m++) {
+      if (!hard_mode_validity_checks[m](word)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  /*
+    Targets dropped by a later move come first, as every move lists the
+    targets it drops before the words that were no longer targets.
+  */
+  const std::vector<int>& targets = targets_left.back();
+  std::copy(targets.begin(), targets.end(), out_remaining_words.words);
+  int num_words = targets.size();
+  for (int m = moves.size() - 1; m >= 1; m--) {
+    auto [guess, verdict] = moves[m];
+    for (int word : targets_left[m - 1]) {
+      if (bank.verdicts[guess][word] != verdict && is_valid_since(m, word)) {
+        out_remaining_words.words[num_words] = word;
+        num_words++;
+      }
+    }
+  }
+  auto [first_guess, first_verdict] = moves[0];
+  for (int i = 0; i < all_words.num_words; i++) {
+    int word = all_words.words[i];
+    if ((i >= all_words.num_targets ||
+         bank.verdicts[first_guess][word] != first_verdict) &&
+        is_valid_since(0, word)) {
+      out_remaining_words.words[num_words] = word;
+      num_words++;
+    }
+  }
+  out_remaining_words.num_words = num_words;
+  out_remaining_words.num_targets = targets.size();
+  return parse_error;
+}
+
+}  // namespace wordy_witch
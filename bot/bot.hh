@@ -2,20 +2,28 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <bit>
 #include <bitset>
 #include <cctype>
 #include <cmath>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <optional>
+#include <random>
+#include <shared_mutex>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 #include "log.hh"
+#include "search_timeline.hh"
+#include "work_stealing.hh"
 
 namespace wordy_witch {
 
@@ -27,18 +35,22 @@ static constexpr int VERDICT_VALUE_BLACK = 0;
 static constexpr int VERDICT_VALUE_YELLOW = 1;
 static constexpr int VERDICT_VALUE_GREEN = 2;
 
-constexpr int NUM_VERDICTS = 243;
+constexpr int count_verdicts(int word_size) {
+  return word_size == 0 ? 1 : 3 * count_verdicts(word_size - 1);
+}
 
+template <int word_size = WORD_SIZE>
 static int judge(const char* guess, const char* target) {
+  constexpr int num_verdicts = count_verdicts(word_size);
   int target_letter_counts[32] = {};
   int verdict = 0;
-  for (int i = 0, t = VERDICT_VALUE_GREEN * NUM_VERDICTS / 3; i < WORD_SIZE;
+  for (int i = 0, t = VERDICT_VALUE_GREEN * num_verdicts / 3; i < word_size;
        i++, t /= 3) {
     int x = guess[i] == target[i];
     verdict += x * t;
     target_letter_counts[target[i] & 31] += !x;
   }
-  for (int i = 0, t = VERDICT_VALUE_YELLOW * NUM_VERDICTS / 3; i < WORD_SIZE;
+  for (int i = 0, t = VERDICT_VALUE_YELLOW * num_verdicts / 3; i < word_size;
        i++, t /= 3) {
     int x = guess[i] != target[i] & target_letter_counts[guess[i] & 31] > 0;
     verdict += x * t;
@@ -49,21 +61,41 @@ static int judge(const char* guess, const char* target) {
 
 static constexpr char VERDICT_TILES[] = {'-', '^', '#'};
 
+template <int word_size = WORD_SIZE>
 std::string format_verdict(int verdict) {
-  std::string tiles(WORD_SIZE, '\0');
-  for (int i = WORD_SIZE - 1; i >= 0; i--) {
+  std::string tiles(word_size, '\0');
+  for (int i = word_size - 1; i >= 0; i--) {
     tiles[i] = VERDICT_TILES[verdict % 3];
     verdict /= 3;
   }
   return tiles;
 }
 
+template <int word_size = WORD_SIZE>
+std::optional<int> parse_verdict(const std::string& tiles) {
+  if (tiles.size() != word_size) {
+    return std::nullopt;
+  }
+  int verdict = 0;
+  for (char tile : tiles) {
+    const char* value = std::find(std::begin(VERDICT_TILES),
+                                  std::end(VERDICT_TILES), tile);
+    if (value == std::end(VERDICT_TILES)) {
+      return std::nullopt;
+    }
+    verdict = verdict * 3 + (value - VERDICT_TILES);
+  }
+  return verdict;
+}
+
+template <int word_size = WORD_SIZE>
 static bool check_is_hard_mode_valid(const char* prev_guess, int prev_verdict,
                                      const char* candidate_guess) {
-  static int VERDICT_TILES_BY_VERDICT[NUM_VERDICTS][WORD_SIZE];
+  constexpr int num_verdicts = count_verdicts(word_size);
+  static int VERDICT_TILES_BY_VERDICT[num_verdicts][word_size];
   static const int precompute_verdict_tiles_by_verdict = []() -> int {
-    for (int verdict = 0; verdict < NUM_VERDICTS; verdict++) {
-      for (int i = WORD_SIZE - 1, v = verdict; i >= 0; i--, v /= 3) {
+    for (int verdict = 0; verdict < num_verdicts; verdict++) {
+      for (int i = word_size - 1, v = verdict; i >= 0; i--, v /= 3) {
         VERDICT_TILES_BY_VERDICT[verdict][i] = v % 3;
       }
     }
@@ -71,17 +103,17 @@ static bool check_is_hard_mode_valid(const char* prev_guess, int prev_verdict,
   }();
 
   const int* verdict_tiles = VERDICT_TILES_BY_VERDICT[prev_verdict];
-  for (int i = 0; i < WORD_SIZE; i++) {
+  for (int i = 0; i < word_size; i++) {
     if (verdict_tiles[i] == VERDICT_VALUE_GREEN &&
         candidate_guess[i] != prev_guess[i]) {
       return false;
     }
   }
   int letter_counts[32] = {};
-  for (int i = 0; i < WORD_SIZE; i++) {
+  for (int i = 0; i < word_size; i++) {
     letter_counts[candidate_guess[i] & 31]++;
   }
-  for (int i = 0; i < WORD_SIZE; i++) {
+  for (int i = 0; i < word_size; i++) {
     letter_counts[prev_guess[i] & 31] -=
         verdict_tiles[i] != VERDICT_VALUE_BLACK;
     if (letter_counts[prev_guess[i] & 31] == -1) {
@@ -91,56 +123,281 @@ static bool check_is_hard_mode_valid(const char* prev_guess, int prev_verdict,
   return true;
 }
 
+/*
+  Hard mode only asks of a guess that it keeps every green letter of the
+  previous guess in place, and that it contains every green or yellow letter
+  at least as many times as the previous verdict showed it. Both conditions
+  are checked on bit patterns instead of letter by letter: a word's letters
+  are packed `HARD_MODE_BITS_PER_LETTER` bits per position, and its letter
+  counts one nibble per letter (by `letter & 31`), each count being at most 7
+  and sitting under a guard bit, so that subtracting the required counts
+  borrows a guard bit away exactly where a count falls short.
+*/
+constexpr int HARD_MODE_BITS_PER_LETTER = 5;
+constexpr int HARD_MODE_MAX_WORD_SIZE = 7;
+constexpr int HARD_MODE_NUM_LETTER_COUNT_WORDS = 2;
+constexpr uint64_t HARD_MODE_LETTER_COUNT_GUARD_BITS = 0x8888888888888888;
+
+struct hard_mode_constraint {
+  uint64_t green_letter_mask;
+  uint64_t green_letters;
+  uint64_t min_letter_counts[HARD_MODE_NUM_LETTER_COUNT_WORDS];
+};
+
+template <int word_size>
+static hard_mode_constraint make_hard_mode_constraint(const char* prev_guess,
+                                                      int prev_verdict) {
+  hard_mode_constraint constraint = {};
+  for (int i = word_size - 1; i >= 0; i--, prev_verdict /= 3) {
+    int letter = prev_guess[i] & 31;
+    int shift = i * HARD_MODE_BITS_PER_LETTER;
+    if (prev_verdict % 3 == VERDICT_VALUE_GREEN) {
+      constraint.green_letter_mask |= uint64_t{31} << shift;
+      constraint.green_letters |= static_cast<uint64_t>(letter) << shift;
+    }
+    if (prev_verdict % 3 != VERDICT_VALUE_BLACK) {
+      constraint.min_letter_counts[letter / 16] += uint64_t{1}
+                                                   << (letter % 16 * 4);
+    }
+  }
+  return constraint;
+}
+
+/*
+  The signatures of a set of words, stored field by field so that checking a
+  constraint against consecutive words vectorizes
+*/
+template <int capacity>
+struct hard_mode_signature_table {
+  std::array<uint64_t, capacity> letters;
+  std::array<std::array<uint64_t, capacity>, HARD_MODE_NUM_LETTER_COUNT_WORDS>
+      letter_counts;
+};
+
+template <int word_size, int capacity>
+static void set_hard_mode_signature(
+    hard_mode_signature_table<capacity>& out_table, int i, const char* word) {
+  static_assert(word_size <= HARD_MODE_MAX_WORD_SIZE);
+  out_table.letters[i] = 0;
+  for (int k = 0; k < HARD_MODE_NUM_LETTER_COUNT_WORDS; k++) {
+    out_table.letter_counts[k][i] = HARD_MODE_LETTER_COUNT_GUARD_BITS;
+  }
+  for (int j = 0; j < word_size; j++) {
+    int letter = word[j] & 31;
+    out_table.letters[i] |= static_cast<uint64_t>(letter)
+                            << (j * HARD_MODE_BITS_PER_LETTER);
+    out_table.letter_counts[letter / 16][i] += uint64_t{1}
+                                               << (letter % 16 * 4);
+  }
+}
+
+template <int capacity, int source_capacity>
+static void copy_hard_mode_signature(
+    hard_mode_signature_table<capacity>& out_table, int i,
+    const hard_mode_signature_table<source_capacity>& table, int j) {
+  out_table.letters[i] = table.letters[j];
+  for (int k = 0; k < HARD_MODE_NUM_LETTER_COUNT_WORDS; k++) {
+    out_table.letter_counts[k][i] = table.letter_counts[k][j];
+  }
+}
+
+template <int capacity>
+static bool satisfies_hard_mode_constraint(
+    const hard_mode_signature_table<capacity>& table, int i,
+    const hard_mode_constraint& constraint) {
+  bool satisfied = (table.letters[i] & constraint.green_letter_mask) ==
+                   constraint.green_letters;
+  for (int k = 0; k < HARD_MODE_NUM_LETTER_COUNT_WORDS; k++) {
+    uint64_t letter_count_surpluses =
+        table.letter_counts[k][i] - constraint.min_letter_counts[k];
+    satisfied &= (letter_count_surpluses & HARD_MODE_LETTER_COUNT_GUARD_BITS) ==
+                 HARD_MODE_LETTER_COUNT_GUARD_BITS;
+  }
+  return satisfied;
+}
+
+/*
+  `out_satisfied[i]` => whether the `i`th word of `table` satisfies
+  `constraint`, for each of the first `num_words` words
+*/
+template <int capacity>
+static void check_hard_mode_constraint(
+    uint8_t* out_satisfied, const hard_mode_signature_table<capacity>& table,
+    int num_words, const hard_mode_constraint& constraint) {
+  for (int i = 0; i < num_words; i++) {
+    out_satisfied[i] = satisfies_hard_mode_constraint(table, i, constraint);
+  }
+}
+
 constexpr int MAX_BANK_SIZE = 1 << 14;
 
-struct word_bank {
-  char words[MAX_BANK_SIZE][WORD_SIZE + 1];
+struct word_list {
+  int num_words;
+  int num_targets;
+  int words[MAX_BANK_SIZE];
+};
+
+/*
+  A word list stored elsewhere, such as a verdict group in the arena of
+  `basic_verdict_groups`; every `word_list` can be read through one
+*/
+struct word_list_view {
+  const int* words = nullptr;
+  int num_words = 0;
+  int num_targets = 0;
+
+  word_list_view() = default;
+  word_list_view(const int* words, int num_words, int num_targets)
+      : words(words), num_words(num_words), num_targets(num_targets) {}
+  word_list_view(const word_list& list)
+      : words(list.words),
+        num_words(list.num_words),
+        num_targets(list.num_targets) {}
+};
+
+void copy_word_list(word_list& out_list, word_list_view list) {
+  if (list.words != out_list.words) {
+    std::copy_n(list.words, list.num_words, out_list.words);
+  }
+  out_list.num_words = list.num_words;
+  out_list.num_targets = list.num_targets;
+}
+
+/*
+  Everything that depends on the word size is fixed at compile time by the
+  bank type, so every word size gets its own fully specialized engine.
+*/
+template <int word_size, bool has_hard_mode_table = false>
+struct basic_word_bank {
+  static constexpr int WORD_SIZE = word_size;
+  static constexpr int NUM_VERDICTS = count_verdicts(word_size);
+  static constexpr int ALL_GREEN_VERDICT = NUM_VERDICTS - 1;
+  using verdict_type =
+      std::conditional_t<NUM_VERDICTS <= 256, uint8_t, uint16_t>;
+  /*
+    Hard mode validity is checked on signatures taking 24 bytes per word. The
+    table answers a single check with one lookup instead, but grows with the
+    square of `NUM_VERDICTS` (about 120 MiB for 5 letters), so it is only
+    built on request.
+  */
+  static constexpr bool HAS_HARD_MODE_TABLE = has_hard_mode_table;
+  static_assert(!HAS_HARD_MODE_TABLE || word_size <= 5);
+  static constexpr bool HAS_HARD_MODE_SIGNATURES =
+      word_size <= HARD_MODE_MAX_WORD_SIZE;
+  static constexpr bool IS_SUB_BANK = false;
+
+  /* Indexed by word id, including the ids of removed words */
+  char words[MAX_BANK_SIZE][word_size + 1];
   int num_words;
   int num_targets;
+  /*
+    Ids handed out so far. Words added later get new ids, and the ids of
+    removed words are never reused, so an id means the same word for the
+    whole life of the bank.
+  */
+  int num_ids;
+  /* Ids of the words currently in the bank, targets first */
+  word_list all_words;
+  /* Depends on the current words only, as opening books are checked by it */
   uint64_t hash;
+  /*
+    Tells what the ids stand for, so it is what cached results are keyed by:
+    it is set by `load_bank` from the words in id order and kept by
+    `add_bank_word` and `remove_bank_word`, since results for word lists that
+    do not involve the changed words stay valid. Copies of a bank updated
+    differently must therefore not share a cache.
+  */
+  uint64_t lineage;
 
-  /* `verdict[guess][target]` => `judge(guess, target)` */
-  uint8_t verdicts[MAX_BANK_SIZE][MAX_BANK_SIZE];
+  /*
+    `verdict[guess][target]` => `judge(guess, target)`, for the ids of
+    current words
+  */
+  verdict_type verdicts[MAX_BANK_SIZE][MAX_BANK_SIZE];
   /*
     `hard_mode_valid_candidates[prev_guess][prev_verdict][candidate_guess_verdict]`
     => under hard mode, whether some candidate word with verdict
     `judge(prev_guess, candidate_word)` may be used as the next guess if
     prev_verdict (i.e. `judge(prev_guess, target)`) was given
   */
-  std::bitset<NUM_VERDICTS> hard_mode_valid_candidates[MAX_BANK_SIZE]
-                                                      [NUM_VERDICTS];
+  std::array<std::array<std::bitset<NUM_VERDICTS>, NUM_VERDICTS>,
+             HAS_HARD_MODE_TABLE ? MAX_BANK_SIZE : 0>
+      hard_mode_valid_candidates;
+  hard_mode_signature_table<HAS_HARD_MODE_SIGNATURES ? MAX_BANK_SIZE : 0>
+      hard_mode_signatures;
 };
 
-void load_bank(word_bank& out_bank, const std::vector<std::string>& words,
+using word_bank = basic_word_bank<WORD_SIZE>;
+
+template <typename bank_type>
+static void compute_bank_hash(bank_type& bank) {
+  const word_list& all_words = bank.all_words;
+  std::vector<std::string> words;
+  for (int i = 0; i < all_words.num_words; i++) {
+    words.push_back(bank.words[all_words.words[i]]);
+  }
+  std::sort(words.begin(), words.begin() + all_words.num_targets);
+  std::sort(words.begin() + all_words.num_targets, words.end());
+  bank.hash = all_words.num_targets;
+  for (const std::string& word : words) {
+    bank.hash *= 31;
+    bank.hash += std::hash<std::string>()(word);
+  }
+}
+
+/*
+  Returns false, leaving `out_bank` untouched, if some word is not
+  `bank_type::WORD_SIZE` letters long or there are too many words
+*/
+template <typename bank_type>
+bool load_bank(bank_type& out_bank, const std::vector<std::string>& words,
                int num_targets) {
+  if (words.size() > MAX_BANK_SIZE) {
+    return false;
+  }
+  for (const std::string& word : words) {
+    if (word.size() != bank_type::WORD_SIZE) {
+      return false;
+    }
+  }
+
   out_bank.num_words = words.size();
   out_bank.num_targets = num_targets;
+  out_bank.num_ids = words.size();
+  out_bank.all_words.num_words = words.size();
+  out_bank.all_words.num_targets = num_targets;
+  std::iota(out_bank.all_words.words, out_bank.all_words.words + words.size(),
+            0);
   for (int i = 0; i < words.size(); i++) {
-    std::copy_n(words.at(i).begin(), WORD_SIZE, out_bank.words[i]);
+    std::copy_n(words.at(i).begin(), bank_type::WORD_SIZE, out_bank.words[i]);
+    out_bank.words[i][bank_type::WORD_SIZE] = '\0';
   }
 
-  auto transform_bank_words_to_upper = [](word_bank& bank) -> void {
+  auto transform_bank_words_to_upper = [](bank_type& bank) -> void {
     for (int i = 0; i < bank.num_words; i++) {
-      for (int j = 0; j < WORD_SIZE; j++) {
+      for (int j = 0; j < bank_type::WORD_SIZE; j++) {
         bank.words[i][j] = std::toupper(bank.words[i][j]);
       }
     }
   };
   transform_bank_words_to_upper(out_bank);
 
-  auto compute_bank_hash = [](word_bank& bank) -> void {
-    bank.hash = bank.num_targets;
-    std::vector<std::string> words(bank.words, bank.words + bank.num_words);
-    std::sort(words.begin(), words.begin() + bank.num_targets);
-    std::sort(words.begin() + bank.num_targets, words.begin() + bank.num_words);
-    for (const std::string& word : words) {
-      bank.hash *= 31;
-      bank.hash += std::hash<std::string>()(word);
-    }
-  };
   compute_bank_hash(out_bank);
+  out_bank.lineage = out_bank.num_targets;
+  for (int i = 0; i < out_bank.num_words; i++) {
+    out_bank.lineage *= 31;
+    out_bank.lineage += std::hash<std::string>()(out_bank.words[i]);
+  }
+
+  if constexpr (bank_type::HAS_HARD_MODE_SIGNATURES) {
+    for (int i = 0; i < out_bank.num_words; i++) {
+      set_hard_mode_signature<bank_type::WORD_SIZE>(
+          out_bank.hard_mode_signatures, i, out_bank.words[i]);
+    }
+  }
 
-  auto precompute_judge_data = [](word_bank& bank) -> void {
+  auto precompute_judge_data = [](bank_type& bank) -> void {
+    constexpr int NUM_VERDICTS = bank_type::NUM_VERDICTS;
     for (int i = 0; i < bank.num_words; i++) {
       if (std::has_single_bit(static_cast<unsigned>(i))) {
         WORDY_WITCH_TRACE("Precomputing judge data", i, bank.num_words);
@@ -148,96 +405,545 @@ void load_bank(word_bank& out_bank, const std::vector<std::string>& words,
       int sample_next_guesses[NUM_VERDICTS];
       std::fill_n(sample_next_guesses, NUM_VERDICTS, -1);
       for (int j = 0; j < bank.num_words; j++) {
-        int verdict = judge(bank.words[i], bank.words[j]);
+        int verdict =
+            judge<bank_type::WORD_SIZE>(bank.words[i], bank.words[j]);
         bank.verdicts[i][j] = verdict;
         sample_next_guesses[verdict] = j;
       }
-      for (int prev_verdict = 0; prev_verdict < NUM_VERDICTS; prev_verdict++) {
-        if (sample_next_guesses[prev_verdict] == -1) {
-          continue;
-        }
-        for (int candidate_verdict = 0; candidate_verdict < NUM_VERDICTS;
-             candidate_verdict++) {
-          if (sample_next_guesses[candidate_verdict] == -1) {
+      if constexpr (bank_type::HAS_HARD_MODE_TABLE) {
+        for (int prev_verdict = 0; prev_verdict < NUM_VERDICTS;
+             prev_verdict++) {
+          if (sample_next_guesses[prev_verdict] == -1) {
             continue;
           }
-          char* candidate_guess =
-              bank.words[sample_next_guesses[candidate_verdict]];
-          int valid = check_is_hard_mode_valid(bank.words[i], prev_verdict,
-                                               candidate_guess);
-          bank.hard_mode_valid_candidates[i][prev_verdict][candidate_verdict] =
-              valid;
+          for (int candidate_verdict = 0; candidate_verdict < NUM_VERDICTS;
+               candidate_verdict++) {
+            if (sample_next_guesses[candidate_verdict] == -1) {
+              continue;
+            }
+            char* candidate_guess =
+                bank.words[sample_next_guesses[candidate_verdict]];
+            int valid = check_is_hard_mode_valid<bank_type::WORD_SIZE>(
+                bank.words[i], prev_verdict, candidate_guess);
+            bank.hard_mode_valid_candidates[i][prev_verdict]
+                                           [candidate_verdict] = valid;
+          }
         }
       }
     }
   };
   precompute_judge_data(out_bank);
+  return true;
 }
 
-std::optional<int> find_word(const word_bank& bank, std::string word) {
-  for (int i = 0; i < bank.num_words; i++) {
-    if (word == bank.words[i]) {
-      return i;
+template <typename bank_type>
+std::optional<int> find_word(const bank_type& bank, std::string word) {
+  for (int i = 0; i < bank.all_words.num_words; i++) {
+    int id = bank.all_words.words[i];
+    if (word == bank.words[id]) {
+      return id;
     }
   }
   return std::nullopt;
 }
 
+/*
+  Adds `word` to `bank` under a new id, judging it only against the current
+  words, and returns that id; cached results stay valid (see
+  `basic_word_bank::lineage`). Returns `std::nullopt`, leaving `bank`
+  untouched, if `word` is not `bank_type::WORD_SIZE` letters long, is already
+  in the bank, or no id is left.
+*/
+template <typename bank_type>
+std::optional<int> add_bank_word(bank_type& bank, std::string word,
+                                 bool is_target) {
+  static_assert(!bank_type::HAS_HARD_MODE_TABLE,
+                "the hard mode table is only built by load_bank");
+  for (char& letter : word) {
+    letter = std::toupper(letter);
+  }
+  if (word.size() != bank_type::WORD_SIZE || find_word(bank, word) ||
+      bank.num_ids == MAX_BANK_SIZE) {
+    return std::nullopt;
+  }
+
+  int id = bank.num_ids;
+  bank.num_ids++;
+  std::copy_n(word.begin(), bank_type::WORD_SIZE, bank.words[id]);
+  bank.words[id][bank_type::WORD_SIZE] = '\0';
+  if constexpr (bank_type::HAS_HARD_MODE_SIGNATURES) {
+    set_hard_mode_signature<bank_type::WORD_SIZE>(bank.hard_mode_signatures,
+                                                  id, bank.words[id]);
+  }
+  word_list& all_words = bank.all_words;
+  int position = is_target ? all_words.num_targets : all_words.num_words;
+  std::copy_backward(all_words.words + position,
+                     all_words.words + all_words.num_words,
+                     all_words.words + all_words.num_words + 1);
+  all_words.words[position] = id;
+  all_words.num_words++;
+  all_words.num_targets += is_target;
+  bank.num_words = all_words.num_words;
+  bank.num_targets = all_words.num_targets;
+
+  for (int i = 0; i < all_words.num_words; i++) {
+    int other = all_words.words[i];
+    bank.verdicts[id][other] =
+        judge<bank_type::WORD_SIZE>(bank.words[id], bank.words[other]);
+    bank.verdicts[other][id] =
+        judge<bank_type::WORD_SIZE>(bank.words[other], bank.words[id]);
+  }
+  compute_bank_hash(bank);
+  return id;
+}
+
+/*
+  Removes the word with id `word` from `bank`, keeping the ids of the others
+  and the cached results that do not involve it; returns false if no such
+  word is in the bank
+*/
+template <typename bank_type>
+bool remove_bank_word(bank_type& bank, int word) {
+  word_list& all_words = bank.all_words;
+  int* end = all_words.words + all_words.num_words;
+  int* it = std::find(all_words.words, end, word);
+  if (it == end) {
+    return false;
+  }
+  bool is_target = it - all_words.words < all_words.num_targets;
+  std::copy(it + 1, end, it);
+  all_words.num_words--;
+  all_words.num_targets -= is_target;
+  bank.num_words = all_words.num_words;
+  bank.num_targets = all_words.num_targets;
+  compute_bank_hash(bank);
+  return true;
+}
+
+/*
+  A bank made of some of the words of a larger `root_bank_type` bank, whose
+  verdicts and hard mode data it reads in place, so that banks overlapping
+  one another (e.g. variants of a game) share a single precompute. Words keep
+  their root bank ids, and so do cached results, which all views of a root
+  bank share (see `basic_word_bank::lineage`); `hash` depends on the view's
+  own words, so opening books built for a standalone bank apply as is.
+*/
+template <typename root_bank_type>
+struct basic_bank_view {
+  static constexpr int WORD_SIZE = root_bank_type::WORD_SIZE;
+  static constexpr int NUM_VERDICTS = root_bank_type::NUM_VERDICTS;
+  static constexpr int ALL_GREEN_VERDICT = root_bank_type::ALL_GREEN_VERDICT;
+  using verdict_type = typename root_bank_type::verdict_type;
+  static constexpr bool HAS_HARD_MODE_TABLE =
+      root_bank_type::HAS_HARD_MODE_TABLE;
+  static constexpr bool HAS_HARD_MODE_SIGNATURES =
+      root_bank_type::HAS_HARD_MODE_SIGNATURES;
+  static constexpr bool IS_SUB_BANK = false;
+
+  const root_bank_type& root_bank;
+  const decltype(root_bank_type::words)& words;
+  int num_words = 0;
+  int num_targets = 0;
+  int num_ids;
+  word_list all_words = {};
+  uint64_t hash = 0;
+  uint64_t lineage;
+  const decltype(root_bank_type::verdicts)& verdicts;
+  const decltype(root_bank_type::hard_mode_valid_candidates)&
+      hard_mode_valid_candidates;
+  const decltype(root_bank_type::hard_mode_signatures)& hard_mode_signatures;
+
+  /* An empty view, to be filled in by `load_bank_view` */
+  explicit basic_bank_view(const root_bank_type& root_bank)
+      : root_bank(root_bank),
+        words(root_bank.words),
+        num_ids(root_bank.num_ids),
+        lineage(root_bank.lineage),
+        verdicts(root_bank.verdicts),
+        hard_mode_valid_candidates(root_bank.hard_mode_valid_candidates),
+        hard_mode_signatures(root_bank.hard_mode_signatures) {}
+};
+
+using word_bank_view = basic_bank_view<word_bank>;
+
+/*
+  Makes `out_view` hold `words` (the first `num_targets` of them being the
+  targets); returns false, leaving `out_view` untouched, if some word is not
+  in the root bank
+*/
+template <typename root_bank_type>
+bool load_bank_view(basic_bank_view<root_bank_type>& out_view,
+                    const std::vector<std::string>& words, int num_targets) {
+  const root_bank_type& root_bank = out_view.root_bank;
+  std::unordered_map<std::string, int> root_words_by_letters;
+  for (int i = 0; i < root_bank.all_words.num_words; i++) {
+    int id = root_bank.all_words.words[i];
+    root_words_by_letters[root_bank.words[id]] = id;
+  }
+  std::vector<int> ids;
+  for (std::string word : words) {
+    for (char& letter : word) {
+      letter = std::toupper(letter);
+    }
+    auto it = root_words_by_letters.find(word);
+    if (it == root_words_by_letters.end()) {
+      return false;
+    }
+    ids.push_back(it->second);
+  }
+
+  out_view.num_ids = root_bank.num_ids;
+  out_view.lineage = root_bank.lineage;
+  out_view.all_words.num_words = ids.size();
+  out_view.all_words.num_targets = num_targets;
+  std::copy(ids.begin(), ids.end(), out_view.all_words.words);
+  out_view.num_words = ids.size();
+  out_view.num_targets = num_targets;
+  compute_bank_hash(out_view);
+  return true;
+}
+
+/* The letters of `word` of `bank`, which may be a sub bank */
+template <typename bank_type>
+static const char* get_word_letters(const bank_type& bank, int word) {
+  if constexpr (bank_type::IS_SUB_BANK) {
+    return bank.root_bank->words[bank.root_words[word]];
+  } else {
+    return bank.words[word];
+  }
+}
+
+/*
+  Returns a predicate telling, under hard mode, whether a candidate may be
+  guessed after `prev_guess` was played and `prev_verdict` was shown; the
+  work shared by all candidates is done once
+*/
+template <typename bank_type>
+static auto make_hard_mode_validity_check(const bank_type& bank,
+                                          int prev_guess, int prev_verdict) {
+  if constexpr (bank_type::HAS_HARD_MODE_TABLE) {
+    return [&bank, prev_guess, prev_verdict](int candidate) -> bool {
+      int candidate_verdict = bank.verdicts[prev_guess][candidate];
+      return bank.hard_mode_valid_candidates[prev_guess][prev_verdict]
+                                            [candidate_verdict];
+    };
+  } else if constexpr (bank_type::HAS_HARD_MODE_SIGNATURES) {
+    return [&bank, constraint = make_hard_mode_constraint<bank_type::WORD_SIZE>(
+                       get_word_letters(bank, prev_guess), prev_verdict)](
+               int candidate) -> bool {
+      return satisfies_hard_mode_constraint(bank.hard_mode_signatures,
+                                            candidate, constraint);
+    };
+  } else {
+    return [&bank, prev_guess_letters = get_word_letters(bank, prev_guess),
+            prev_verdict](int candidate) -> bool {
+      return check_is_hard_mode_valid<bank_type::WORD_SIZE>(
+          prev_guess_letters, prev_verdict, get_word_letters(bank, candidate));
+    };
+  }
+}
+
 #pragma endregion
 
 #pragma region playing
 
 constexpr int MAX_NUM_ATTEMPTS_ALLOWED = 6;
 
-struct word_list {
-  int num_words;
-  int num_targets;
-  int words[MAX_BANK_SIZE];
+/*
+  The remaining words split by the verdict of a guess. Groups are views into
+  one arena, which keeps the largest size needed so far, so scratch memory
+  follows the sizes of the groups rather than their number.
+*/
+template <int num_verdicts>
+struct basic_verdict_groups {
+  std::array<word_list_view, num_verdicts> groups;
+  std::unique_ptr<int[]> arena;
+  int arena_size = 0;
+
+  word_list_view operator[](int verdict) const { return groups[verdict]; }
+  auto begin() const { return groups.begin(); }
+  auto end() const { return groups.end(); }
 };
 
-using verdict_groups = word_list[NUM_VERDICTS];
+template <typename bank_type>
+using verdict_groups_for = basic_verdict_groups<bank_type::NUM_VERDICTS>;
+
+using verdict_groups = verdict_groups_for<word_bank>;
 
-void group_remaining_words(verdict_groups& out_groups, const word_bank& bank,
-                           const word_list& remaining_words, int guess,
+template <int num_verdicts>
+static int* reserve_verdict_group_arena(
+    basic_verdict_groups<num_verdicts>& groups, int64_t size) {
+  if (size > groups.arena_size) {
+    groups.arena_size = std::max<int64_t>(size, groups.arena_size * 2);
+    groups.arena = std::make_unique_for_overwrite<int[]>(groups.arena_size);
+  }
+  return groups.arena.get();
+}
+
+/*
+  Targets are scattered into their groups by counting first; every group
+  with targets then gets a copy of its targets followed by the other words
+  still guessable in it, one group after another
+*/
+template <typename bank_type>
+void group_remaining_words(verdict_groups_for<bank_type>& out_groups,
+                           const bank_type& bank,
+                           word_list_view remaining_words, int guess,
                            bool group_targets_only = false) {
-  for (word_list& group : out_groups) {
-    group.num_words = 0;
-    group.num_targets = 0;
+  constexpr int NUM_VERDICTS = bank_type::NUM_VERDICTS;
+  const auto& guess_verdicts = bank.verdicts[guess];
+  int num_targets_by_verdict[NUM_VERDICTS] = {};
+  for (int i = 0; i < remaining_words.num_targets; i++) {
+    num_targets_by_verdict[guess_verdicts[remaining_words.words[i]]]++;
+  }
+  int num_groups_with_targets = 0;
+  for (int verdict = 0; verdict < NUM_VERDICTS; verdict++) {
+    num_groups_with_targets += num_targets_by_verdict[verdict] > 0;
+  }
+  /* With a slot to spare for the branchless appends below */
+  int* arena = reserve_verdict_group_arena(
+      out_groups,
+      remaining_words.num_targets + 1 +
+          (group_targets_only ? 0
+                              : static_cast<int64_t>(num_groups_with_targets) *
+                                    remaining_words.num_words));
+
+  int* target_slots[NUM_VERDICTS];
+  int* next_slot = arena;
+  for (int verdict = 0; verdict < NUM_VERDICTS; verdict++) {
+    int num_targets = num_targets_by_verdict[verdict];
+    out_groups.groups[verdict] = {next_slot, num_targets, num_targets};
+    target_slots[verdict] = next_slot;
+    next_slot += num_targets;
   }
   for (int i = 0; i < remaining_words.num_targets; i++) {
     int candidate = remaining_words.words[i];
-    int verdict = bank.verdicts[guess][candidate];
-    word_list& group = out_groups[verdict];
-    group.words[group.num_words] = candidate;
-    group.num_words++;
-    group.num_targets++;
+    *target_slots[guess_verdicts[candidate]]++ = candidate;
   }
   if (group_targets_only) {
     return;
   }
 
+  auto start_group = [&](int verdict) -> int* {
+    word_list_view targets = out_groups.groups[verdict];
+    int* words = next_slot;
+    std::copy_n(targets.words, targets.num_targets, words);
+    return words;
+  };
+  auto finish_group = [&](int verdict, int* words, int num_words) -> void {
+    out_groups.groups[verdict] = {words, num_words,
+                                  num_targets_by_verdict[verdict]};
+    next_slot += num_words;
+  };
+
+  if constexpr (bank_type::HAS_HARD_MODE_SIGNATURES &&
+                !bank_type::HAS_HARD_MODE_TABLE) {
+    /*
+      Every group checks its constraint against all remaining words, so
+      their signatures are gathered in list order once
+    */
+    static thread_local std::unique_ptr<
+        hard_mode_signature_table<MAX_BANK_SIZE>>
+        preallocated_signatures =
+            std::make_unique_for_overwrite<
+                hard_mode_signature_table<MAX_BANK_SIZE>>();
+    static thread_local std::unique_ptr<uint8_t[]> preallocated_satisfied =
+        std::make_unique_for_overwrite<uint8_t[]>(MAX_BANK_SIZE);
+    hard_mode_signature_table<MAX_BANK_SIZE>& signatures =
+        *preallocated_signatures;
+    uint8_t* satisfied = preallocated_satisfied.get();
+    for (int i = 0; i < remaining_words.num_words; i++) {
+      copy_hard_mode_signature(signatures, i, bank.hard_mode_signatures,
+                               remaining_words.words[i]);
+    }
+    const char* guess_letters = get_word_letters(bank, guess);
+    for (int verdict = 0; verdict < NUM_VERDICTS; verdict++) {
+      if (num_targets_by_verdict[verdict] == 0) {
+        continue;
+      }
+      check_hard_mode_constraint(
+          satisfied, signatures, remaining_words.num_words,
+          make_hard_mode_constraint<bank_type::WORD_SIZE>(guess_letters,
+                                                          verdict));
+      int* words = start_group(verdict);
+      int num_words = num_targets_by_verdict[verdict];
+      /* Targets with an exact verdict match were already added. */
+      for (int i = 0; i < remaining_words.num_targets; i++) {
+        int candidate = remaining_words.words[i];
+        words[num_words] = candidate;
+        num_words += satisfied[i] & (guess_verdicts[candidate] != verdict);
+      }
+      for (int i = remaining_words.num_targets;
+           i < remaining_words.num_words; i++) {
+        words[num_words] = remaining_words.words[i];
+        num_words += satisfied[i];
+      }
+      finish_group(verdict, words, num_words);
+    }
+    return;
+  }
+
   for (int verdict = 0; verdict < NUM_VERDICTS; verdict++) {
-    word_list& group = out_groups[verdict];
-    if (group.num_targets == 0) {
+    if (num_targets_by_verdict[verdict] == 0) {
       continue;
     }
+    auto is_hard_mode_valid_candidate =
+        make_hard_mode_validity_check(bank, guess, verdict);
+    int* words = start_group(verdict);
+    int num_words = num_targets_by_verdict[verdict];
     for (int i = 0; i < remaining_words.num_words; i++) {
       int candidate = remaining_words.words[i];
-      int candidate_verdict = bank.verdicts[guess][candidate];
+      int candidate_verdict = guess_verdicts[candidate];
       if (i < remaining_words.num_targets && candidate_verdict == verdict) {
         /* This candidate was already added with exact verdict match. */
         continue;
       }
-      if (!bank.hard_mode_valid_candidates[guess][verdict][candidate_verdict]) {
+      if (!is_hard_mode_valid_candidate(candidate)) {
         continue;
       }
-      group.words[group.num_words] = candidate;
-      group.num_words++;
+      words[num_words] = candidate;
+      num_words++;
+    }
+    finish_group(verdict, words, num_words);
+  }
+}
+
+constexpr int MAX_SUB_BANK_SIZE = 512;
+/*
+  Copying the verdicts among all words of a node only pays off when the
+  search below it looks them up often enough, which takes enough targets
+*/
+constexpr int MAX_NUM_SUB_BANK_WORDS_PER_TARGET = 8;
+
+/*
+  A dense copy of the verdicts among the words of a small word list of
+  `root_bank_type`, with the words renumbered in list order. Deep in the
+  search tree, every verdict lookup of a node would otherwise land on a
+  different cache line of the root bank; a whole subtree is searched on a sub
+  bank instead, and word ids are translated back only for results.
+*/
+template <typename root_bank_type_>
+struct basic_sub_bank {
+  using root_bank_type = root_bank_type_;
+  static constexpr int WORD_SIZE = root_bank_type::WORD_SIZE;
+  static constexpr int NUM_VERDICTS = root_bank_type::NUM_VERDICTS;
+  static constexpr int ALL_GREEN_VERDICT = root_bank_type::ALL_GREEN_VERDICT;
+  using verdict_type = typename root_bank_type::verdict_type;
+  static constexpr bool HAS_HARD_MODE_TABLE = false;
+  static constexpr bool HAS_HARD_MODE_SIGNATURES =
+      root_bank_type::HAS_HARD_MODE_SIGNATURES;
+  static constexpr bool IS_SUB_BANK = true;
+
+  const root_bank_type* root_bank;
+  int num_words;
+  int num_targets;
+  /* Same as the root bank, so that both share cached results */
+  uint64_t lineage;
+
+  /* `root_words[word]` => id of `word` in the root bank */
+  int root_words[MAX_SUB_BANK_SIZE];
+  /*
+    `words_by_root_word[root_word]` => id of `root_word` in this sub bank,
+    only meaningful for the root words in it
+  */
+  int words_by_root_word[MAX_BANK_SIZE];
+  /* `verdict[guess][target]` => `judge(guess, target)` */
+  verdict_type verdicts[MAX_SUB_BANK_SIZE][MAX_SUB_BANK_SIZE];
+  hard_mode_signature_table<HAS_HARD_MODE_SIGNATURES ? MAX_SUB_BANK_SIZE : 0>
+      hard_mode_signatures;
+};
+
+/*
+  Builds a sub bank out of `root_remaining_words` (at most
+  `MAX_SUB_BANK_SIZE` words), along with the same list in sub bank ids
+*/
+template <typename root_bank_type>
+void load_sub_bank(basic_sub_bank<root_bank_type>& out_sub_bank,
+                   word_list& out_remaining_words,
+                   const root_bank_type& root_bank,
+                   word_list_view root_remaining_words) {
+  int num_words = root_remaining_words.num_words;
+  out_sub_bank.root_bank = &root_bank;
+  out_sub_bank.num_words = num_words;
+  out_sub_bank.num_targets = root_remaining_words.num_targets;
+  out_sub_bank.lineage = root_bank.lineage;
+  for (int i = 0; i < num_words; i++) {
+    int root_word = root_remaining_words.words[i];
+    out_sub_bank.root_words[i] = root_word;
+    out_sub_bank.words_by_root_word[root_word] = i;
+    if constexpr (basic_sub_bank<root_bank_type>::HAS_HARD_MODE_SIGNATURES) {
+      copy_hard_mode_signature(out_sub_bank.hard_mode_signatures, i,
+                               root_bank.hard_mode_signatures, root_word);
+    }
+  }
+  for (int i = 0; i < num_words; i++) {
+    const auto& root_verdicts =
+        root_bank.verdicts[root_remaining_words.words[i]];
+    for (int j = 0; j < num_words; j++) {
+      out_sub_bank.verdicts[i][j] =
+          root_verdicts[root_remaining_words.words[j]];
     }
   }
+
+  out_remaining_words.num_words = num_words;
+  out_remaining_words.num_targets = root_remaining_words.num_targets;
+  std::iota(out_remaining_words.words, out_remaining_words.words + num_words,
+            0);
+}
+
+/* Id of `word` of `bank` in the bank that results are cached for */
+template <typename bank_type>
+int get_root_word(const bank_type& bank, int word) {
+  if constexpr (bank_type::IS_SUB_BANK) {
+    return bank.root_words[word];
+  } else {
+    return word;
+  }
+}
+
+template <typename bank_type>
+int find_word_by_root_word(const bank_type& bank, int root_word) {
+  if constexpr (bank_type::IS_SUB_BANK) {
+    return bank.words_by_root_word[root_word];
+  } else {
+    return root_word;
+  }
 }
 
-static constexpr int ALL_GREEN_VERDICT = NUM_VERDICTS - 1;
+template <typename bank_type>
+const int* get_root_words(const bank_type& bank) {
+  if constexpr (bank_type::IS_SUB_BANK) {
+    return bank.root_words;
+  } else {
+    return nullptr;
+  }
+}
+
+template <typename bank_type>
+void list_all_words(word_list& out_list, const bank_type& bank) {
+  if constexpr (bank_type::IS_SUB_BANK) {
+    out_list.num_words = bank.num_words;
+    out_list.num_targets = bank.num_targets;
+    std::iota(out_list.words, out_list.words + bank.num_words, 0);
+  } else {
+    out_list = bank.all_words;
+  }
+}
+
+/*
+  Narrows `remaining_words` down to the words still possible (and still
+  guessable under hard mode) after `guess` was played and `verdict` was shown
+*/
+template <typename bank_type>
+void apply_verdict(word_list& remaining_words, const bank_type& bank,
+                   int guess, int verdict) {
+  static thread_local std::unique_ptr<verdict_groups_for<bank_type>>
+      preallocated_groups =
+          std::make_unique_for_overwrite<verdict_groups_for<bank_type>>();
+  verdict_groups_for<bank_type>& groups = *preallocated_groups;
+  group_remaining_words(groups, bank, remaining_words, guess);
+  copy_word_list(remaining_words, groups[verdict]);
+}
 
 constexpr double INFINITE_COST = std::numeric_limits<double>::infinity();
 
@@ -249,7 +955,12 @@ struct candidate_info {
 static constexpr int NUM_CODES_IN_GROUP_HASH = 2;
 using word_list_hash = std::array<uint64_t, NUM_CODES_IN_GROUP_HASH>;
 
-static word_list_hash hash_word_list(const word_list& list) {
+/*
+  Hashes the words of `list` as they are, or as `root_words[word]` if
+  `root_words` is given (see `get_root_words`)
+*/
+static word_list_hash hash_word_list(word_list_view list,
+                                     const int* root_words = nullptr) {
   static constexpr uint64_t MOD[] = {(1ULL << 63) - 25, (1ULL << 63) - 165};
 
   static uint64_t pow_2_mod[MAX_BANK_SIZE * 2][NUM_CODES_IN_GROUP_HASH];
@@ -267,8 +978,9 @@ static word_list_hash hash_word_list(const word_list& list) {
   for (int i = 0; i < list.num_words; i++) {
     for (int m = 0; m < NUM_CODES_IN_GROUP_HASH; m++) {
       bool is_word_target = i < list.num_targets;
-      int encoded_word_index =
-          list.words[i] + (is_word_target ? MAX_BANK_SIZE : 0);
+      int word =
+          root_words == nullptr ? list.words[i] : root_words[list.words[i]];
+      int encoded_word_index = word + (is_word_target ? MAX_BANK_SIZE : 0);
       hash[m] += pow_2_mod[encoded_word_index][m];
       hash[m] %= MOD[m];
     }
@@ -284,28 +996,165 @@ template <typename return_type, typename... args_type>
 static uint64_t get_function_address(
     std::function<return_type(args_type...)> f) {
   using function_type = return_type(args_type...);
-  function_type* pointer = f.template target<function_type>();
-  return reinterpret_cast<uint64_t>(pointer);
+  function_type* const* pointer = f.template target<function_type*>();
+  if (pointer == nullptr) {
+    return 0;
+  }
+  return reinterpret_cast<uint64_t>(*pointer);
 }
 
+struct candidate_pruning_policy {
+  int max_entropy_place_to_consider;
+  std::optional<int> max_entropy_place_to_consider_for_initial_attempt;
+  /* Candidates this far below the best entropy (in bits) are pruned */
+  double max_entropy_difference_to_consider = 1.0;
+  /*
+    Up to this many attempts used, candidates are also pruned by the entropy
+    of two attempts, and only half as many entropy places are considered
+  */
+  int max_num_attempts_used_to_prune_by_two_attempt_entropy = 1;
+  /*
+    Nodes with at least this many targets, if set, rank their candidates by
+    `estimate_guess_cost` with `num_estimation_samples` samples, and only
+    evaluate the `max_num_candidates_to_evaluate_after_estimation` best ones
+  */
+  std::optional<int> min_num_targets_to_estimate;
+  int num_estimation_samples = 256;
+  int max_num_candidates_to_evaluate_after_estimation = 4;
+};
+
+/*
+  Everything about a pruning policy that affects the search from a node down,
+  after some number of attempts were used
+*/
+struct candidate_pruning_key {
+  /* Effective at the node itself */
+  int max_entropy_place_to_consider;
+  /* Effective below the node, before halving */
+  int max_entropy_place_to_consider_below;
+  double max_entropy_difference_to_consider;
+  /* Including the node itself */
+  int num_attempts_left_to_prune_by_two_attempt_entropy;
+  /* All zero if candidates are never ranked by estimates */
+  int min_num_targets_to_estimate;
+  int num_estimation_samples;
+  int max_num_candidates_to_evaluate_after_estimation;
+
+  bool operator==(const candidate_pruning_key& other) const = default;
+};
+
+candidate_pruning_key get_candidate_pruning_key(
+    candidate_pruning_policy pruning_policy, int num_attempts_used) {
+  int num_attempts_left_to_prune_by_two_attempt_entropy = std::max(
+      pruning_policy.max_num_attempts_used_to_prune_by_two_attempt_entropy -
+          num_attempts_used + 1,
+      0);
+  int max_entropy_place_to_consider =
+      pruning_policy.max_entropy_place_to_consider;
+  if (num_attempts_used == 0 &&
+      pruning_policy.max_entropy_place_to_consider_for_initial_attempt
+          .has_value()) {
+    max_entropy_place_to_consider =
+        pruning_policy.max_entropy_place_to_consider_for_initial_attempt
+            .value();
+  } else if (num_attempts_left_to_prune_by_two_attempt_entropy > 0) {
+    max_entropy_place_to_consider =
+        std::max(max_entropy_place_to_consider / 2, 1);
+  }
+  return candidate_pruning_key{
+      .max_entropy_place_to_consider = max_entropy_place_to_consider,
+      .max_entropy_place_to_consider_below =
+          pruning_policy.max_entropy_place_to_consider,
+      .max_entropy_difference_to_consider =
+          pruning_policy.max_entropy_difference_to_consider,
+      .num_attempts_left_to_prune_by_two_attempt_entropy =
+          num_attempts_left_to_prune_by_two_attempt_entropy,
+      .min_num_targets_to_estimate =
+          pruning_policy.min_num_targets_to_estimate.value_or(0),
+      .num_estimation_samples =
+          pruning_policy.min_num_targets_to_estimate.has_value()
+              ? pruning_policy.num_estimation_samples
+              : 0,
+      .max_num_candidates_to_evaluate_after_estimation =
+          pruning_policy.min_num_targets_to_estimate.has_value()
+              ? pruning_policy.max_num_candidates_to_evaluate_after_estimation
+              : 0,
+  };
+}
+
+uint64_t hash_candidate_pruning_key(candidate_pruning_key key) {
+  uint64_t combined_hash = key.max_entropy_place_to_consider;
+  combined_hash = combined_hash * 31 + key.max_entropy_place_to_consider_below;
+  combined_hash =
+      combined_hash * 31 +
+      std::bit_cast<uint64_t>(key.max_entropy_difference_to_consider);
+  combined_hash = combined_hash * 31 +
+                  key.num_attempts_left_to_prune_by_two_attempt_entropy;
+  combined_hash = combined_hash * 31 + key.min_num_targets_to_estimate;
+  combined_hash = combined_hash * 31 + key.num_estimation_samples;
+  combined_hash = combined_hash * 31 +
+                  key.max_num_candidates_to_evaluate_after_estimation;
+  return combined_hash;
+}
+
+/*
+  Returns `a` if `get_guess_cost(u) = a * u + b` for every number of attempts
+  used. Under such a cost, solving some targets from a deeper node costs the
+  same up to `a` times the attempts used per target, so the best guess does
+  not depend on the depth.
+*/
+std::optional<double> find_affine_guess_cost_slope(
+    const guess_cost_function& get_guess_cost) {
+  /* Every node asks, nearly always about the same plain function. */
+  static thread_local std::pair<uint64_t, std::optional<double>> last_slope;
+  uint64_t address = get_function_address(get_guess_cost);
+  if (address != 0 && address == last_slope.first) {
+    return last_slope.second;
+  }
+  std::optional<double> slope = get_guess_cost(2) - get_guess_cost(1);
+  for (int i = 2; i < MAX_NUM_ATTEMPTS_ALLOWED; i++) {
+    if (get_guess_cost(i + 1) - get_guess_cost(i) != slope.value()) {
+      slope = std::nullopt;
+      break;
+    }
+  }
+  if (address != 0) {
+    last_slope = {address, slope};
+  }
+  return slope;
+}
+
+/* Cached results are shared by every node with the same key */
+constexpr int ANY_DEPTH = -1;
+
+/*
+  Results are cached by the number of attempts left, though nodes with fewer
+  may share them (see `find_cached_best_guess`); `depth` is the number of
+  attempts used, or `ANY_DEPTH` under an affine cost, where cached costs
+  leave out the slope times the attempts used per target
+*/
 struct find_best_guess_cache_key {
-  uint64_t bank_hash;
+  /* See `basic_word_bank::lineage` */
+  uint64_t bank_lineage;
   word_list_hash remaining_words_hash;
   guess_cost_function get_guess_cost;
-  int max_entropy_place_to_consider_pruning;
+  candidate_pruning_key pruning;
+  int depth;
 
   bool operator==(const find_best_guess_cache_key& other) const {
     auto l = std::tuple{
-        bank_hash,
+        bank_lineage,
         remaining_words_hash,
         get_function_address(get_guess_cost),
-        max_entropy_place_to_consider_pruning,
+        pruning,
+        depth,
     };
     auto r = std::tuple{
-        other.bank_hash,
+        other.bank_lineage,
         other.remaining_words_hash,
         get_function_address(other.get_guess_cost),
-        other.max_entropy_place_to_consider_pruning,
+        other.pruning,
+        other.depth,
     };
     return l == r;
   }
@@ -313,52 +1162,197 @@ struct find_best_guess_cache_key {
 
 struct find_best_guess_cache_key_hasher {
   uint64_t operator()(find_best_guess_cache_key key) const {
-    uint64_t combined_hash = key.bank_hash;
+    uint64_t combined_hash = key.bank_lineage;
     for (uint64_t code : key.remaining_words_hash) {
       combined_hash = combined_hash * 31 + code;
     }
     combined_hash =
         combined_hash * 31 + get_function_address(key.get_guess_cost);
     combined_hash =
-        combined_hash * 31 + key.max_entropy_place_to_consider_pruning;
+        combined_hash * 31 + hash_candidate_pruning_key(key.pruning);
+    combined_hash = combined_hash * 31 + key.depth;
     return combined_hash;
   }
 };
 
+/*
+  Besides the best guess, a cached result counts the targets solved by each
+  attempt of the strategy below it, which is all it takes to cost that
+  strategy under another cost model (see `rescore_cached_strategy`)
+*/
+struct cached_best_guess {
+  /* Root word id */
+  int guess;
+  /* Leaving out the depth cost (see `find_best_guess_cache_key`) */
+  double cost;
+  /*
+    `num_targets_solved_by_attempts_used[k]` => number of targets solved by
+    the guess played after `k` attempts, counted from the node; unknown for
+    the results of `preload_best_guess`
+  */
+  std::optional<std::array<int, MAX_NUM_ATTEMPTS_ALLOWED>>
+      num_targets_solved_by_attempts_used;
+};
+
 using find_best_guess_cache =
-    std::unordered_map<find_best_guess_cache_key, candidate_info,
+    std::unordered_map<find_best_guess_cache_key, cached_best_guess,
                        find_best_guess_cache_key_hasher>;
 
+/* Counts of the work done by the searches sharing a `bot_cache` */
+struct bot_stats {
+  /* `find_best_guess` calls that were neither trivial nor cached */
+  std::atomic<int64_t> num_nodes_searched;
+  /* `evaluate_guess` calls made by those nodes */
+  std::atomic<int64_t> num_guesses_evaluated;
+  /* `find_best_guess` calls answered from the cache */
+  std::atomic<int64_t> num_cache_hits;
+};
+
+/*
+  A `bot_cache` may be shared by searches running on different threads; every
+  access to the result caches goes through `mutex`.
+*/
 struct bot_cache {
-  find_best_guess_cache find_best_guess_cache_by_attempts_allowed_and_used
-      [MAX_NUM_ATTEMPTS_ALLOWED][MAX_NUM_ATTEMPTS_ALLOWED];
+  find_best_guess_cache
+      find_best_guess_cache_by_attempts_left[MAX_NUM_ATTEMPTS_ALLOWED];
+  std::shared_mutex mutex;
+  bot_stats stats;
+  /* Where searches record their nodes, if anywhere */
+  search_timeline* timeline = nullptr;
 };
 
+/*
+  Returns the result cached for `key` with `num_attempts_left` attempts left,
+  else one cached with more attempts left that is known to be the same: a
+  lost node is also lost with fewer attempts, and a strategy needing no more
+  than `num_attempts_left` attempts is also the best with that many, as the
+  attempts left only rule strategies out (the pruning key being the same
+  below). Estimates do depend on the attempts left, so results ranked by
+  them are not shared. The caller must hold `cache.mutex`.
+*/
+static const cached_best_guess* find_cached_best_guess(
+    const bot_cache& cache, int num_attempts_left,
+    const find_best_guess_cache_key& key) {
+  const find_best_guess_cache& result_cache =
+      cache.find_best_guess_cache_by_attempts_left[num_attempts_left - 1];
+  if (auto it = result_cache.find(key); it != result_cache.end()) {
+    return &it->second;
+  }
+  if (key.pruning.min_num_targets_to_estimate != 0) {
+    return nullptr;
+  }
+  for (int i = num_attempts_left; i < MAX_NUM_ATTEMPTS_ALLOWED; i++) {
+    const find_best_guess_cache& other_cache =
+        cache.find_best_guess_cache_by_attempts_left[i];
+    auto it = other_cache.find(key);
+    if (it == other_cache.end()) {
+      continue;
+    }
+    if (it->second.cost >= INFINITE_COST) {
+      return &it->second;
+    }
+    if (!it->second.num_targets_solved_by_attempts_used.has_value()) {
+      continue;
+    }
+    const auto& num_targets_solved =
+        it->second.num_targets_solved_by_attempts_used.value();
+    if (std::all_of(num_targets_solved.begin() + num_attempts_left,
+                    num_targets_solved.end(),
+                    [](int n) -> bool { return n == 0; })) {
+      return &it->second;
+    }
+  }
+  return nullptr;
+}
+
+/*
+  Inside a `work_stealing_pool`, nodes with at least this many targets search
+  their candidates and verdict groups as tasks. Smaller nodes are searched
+  sequentially by a single task, where spawning would cost more than it
+  saves; so are sub banks, which are small by construction and shared by a
+  thread's whole subtree.
+*/
+constexpr int MIN_NUM_TARGETS_TO_SEARCH_IN_PARALLEL = 64;
+
+template <typename bank_type>
+static bool should_search_in_parallel(const bank_type& bank,
+                                      word_list_view remaining_words) {
+  return !bank_type::IS_SUB_BANK && is_in_work_stealing_pool() &&
+         remaining_words.num_targets >= MIN_NUM_TARGETS_TO_SEARCH_IN_PARALLEL;
+}
+
 using find_best_guess_callback_for_candidate =
     std::function<void(candidate_info candidate)>;
 
-struct candidate_pruning_policy {
-  int max_entropy_place_to_consider;
-  std::optional<int> max_entropy_place_to_consider_for_initial_attempt;
-};
-
 constexpr candidate_pruning_policy default_candidate_pruning_policy = {
     .max_entropy_place_to_consider = 32,
 };
 
+/*
+  Also sets `out_depth_cost` to the part of the cost left out of cached
+  results (see `find_best_guess_cache_key`)
+*/
+template <typename bank_type>
+find_best_guess_cache_key make_find_best_guess_cache_key(
+    double& out_depth_cost, const bank_type& bank, int num_attempts_used,
+    word_list_view remaining_words, guess_cost_function get_guess_cost,
+    candidate_pruning_policy pruning_policy) {
+  std::optional<double> guess_cost_slope =
+      find_affine_guess_cost_slope(get_guess_cost);
+  out_depth_cost = guess_cost_slope.has_value()
+                       ? guess_cost_slope.value() * num_attempts_used *
+                             remaining_words.num_targets
+                       : 0.0;
+  return find_best_guess_cache_key{
+      .bank_lineage = bank.lineage,
+      .remaining_words_hash =
+          hash_word_list(remaining_words, get_root_words(bank)),
+      .get_guess_cost = get_guess_cost,
+      .pruning = get_candidate_pruning_key(pruning_policy, num_attempts_used),
+      .depth = guess_cost_slope.has_value() ? ANY_DEPTH : num_attempts_used,
+  };
+}
+
+/*
+  Records `best_guess` as the result of the `find_best_guess` call with the
+  same arguments, e.g. one computed offline (see `cli.hh`)
+*/
+template <typename bank_type>
+void preload_best_guess(const bank_type& bank, bot_cache& cache,
+                        int num_attempts_allowed, int num_attempts_used,
+                        word_list_view remaining_words,
+                        guess_cost_function get_guess_cost,
+                        candidate_pruning_policy pruning_policy,
+                        candidate_info best_guess) {
+  double depth_cost;
+  find_best_guess_cache_key cache_key = make_find_best_guess_cache_key(
+      depth_cost, bank, num_attempts_used, remaining_words, get_guess_cost,
+      pruning_policy);
+  std::unique_lock lock(cache.mutex);
+  cache.find_best_guess_cache_by_attempts_left[num_attempts_allowed -
+                                               num_attempts_used - 1]
+                                              [cache_key] = {
+      .guess = get_root_word(bank, best_guess.guess),
+      .cost = best_guess.cost - depth_cost,
+  };
+}
+
+template <typename bank_type>
 candidate_info find_best_guess(
-    const word_bank& bank, bot_cache& cache, int num_attempts_allowed,
-    int num_attempts_used, const word_list& remaining_words,
-    find_best_guess_callback_for_candidate callback_for_candidate,
-    guess_cost_function get_guess_cost,
-    candidate_pruning_policy pruning_policy);
+    const bank_type& bank, bot_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, word_list_view remaining_words,
+    find_best_guess_callback_for_candidate callback_for_candidate = {},
+    guess_cost_function get_guess_cost = get_flat_guess_cost,
+    candidate_pruning_policy pruning_policy =
+        default_candidate_pruning_policy);
 
 using evaluate_guess_callback_for_verdict_group = std::function<void(
-    int verdict, const word_list& verdict_group, candidate_info best_guess)>;
+    int verdict, word_list_view verdict_group, candidate_info best_guess)>;
 
+template <typename bank_type>
 double evaluate_guess(
-    const word_bank& bank, bot_cache& cache, int num_attempts_allowed,
-    int num_attempts_used, const word_list& remaining_words, int guess,
+    const bank_type& bank, bot_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, word_list_view remaining_words, int guess,
     evaluate_guess_callback_for_verdict_group callback_for_verdict_group = {},
     guess_cost_function get_guess_cost = get_flat_guess_cost,
     candidate_pruning_policy pruning_policy =
@@ -369,17 +1363,62 @@ double evaluate_guess(
   if (num_attempts_used == num_attempts_allowed) {
     return INFINITE_COST;
   }
-
-  static verdict_groups
-      preallocated_groups_by_attempts_used[MAX_NUM_ATTEMPTS_ALLOWED];
-  verdict_groups& groups =
-      preallocated_groups_by_attempts_used[num_attempts_used];
+  search_timeline_span span(cache.timeline, "evaluate_guess",
+                            num_attempts_used, remaining_words.num_words,
+                            remaining_words.num_targets,
+                            get_word_letters(bank, guess));
+
+  bool searches_in_parallel = should_search_in_parallel(bank, remaining_words);
+  static thread_local std::unique_ptr<verdict_groups_for<bank_type>[]>
+      preallocated_groups_by_attempts_used =
+          std::make_unique_for_overwrite<verdict_groups_for<bank_type>[]>(
+              MAX_NUM_ATTEMPTS_ALLOWED);
+  std::optional<recycled_buffer<verdict_groups_for<bank_type>>>
+      recycled_groups;
+  verdict_groups_for<bank_type>& groups =
+      searches_in_parallel || callback_for_verdict_group
+          ? *recycled_groups.emplace()
+          : preallocated_groups_by_attempts_used[num_attempts_used];
   group_remaining_words(groups, bank, remaining_words, guess);
 
+  /*
+    Groups are searched as tasks, but their results are summed up in the same
+    order as in a sequential search, so that the costs are the same to the
+    last bit. Once some group is lost, the others are not worth searching,
+    unless the caller wants to hear about them.
+  */
+  std::vector<std::optional<candidate_info>> best_guesses_by_verdict;
+  if (searches_in_parallel) {
+    best_guesses_by_verdict.resize(bank_type::NUM_VERDICTS);
+    std::atomic<bool> has_lost_group = false;
+    task_group tasks;
+    /* Spawned in reverse, so that this thread takes them in order. */
+    for (int verdict = 0; verdict < bank_type::NUM_VERDICTS; verdict++) {
+      if (verdict == bank_type::ALL_GREEN_VERDICT ||
+          groups[verdict].num_targets == 0) {
+        continue;
+      }
+      spawn_task(tasks, [&, verdict]() -> void {
+        if (has_lost_group.load(std::memory_order_relaxed) &&
+            !callback_for_verdict_group) {
+          return;
+        }
+        candidate_info best_guess = find_best_guess(
+            bank, cache, num_attempts_allowed, num_attempts_used,
+            groups[verdict], {}, get_guess_cost, pruning_policy);
+        if (best_guess.cost >= INFINITE_COST) {
+          has_lost_group.store(true, std::memory_order_relaxed);
+        }
+        best_guesses_by_verdict[verdict] = best_guess;
+      });
+    }
+    wait_for_tasks(tasks);
+  }
+
   double cost = 0.0;
-  for (int verdict = NUM_VERDICTS - 1; verdict >= 0; verdict--) {
-    const word_list& group = groups[verdict];
-    if (verdict == ALL_GREEN_VERDICT) {
+  for (int verdict = bank_type::NUM_VERDICTS - 1; verdict >= 0; verdict--) {
+    word_list_view group = groups[verdict];
+    if (verdict == bank_type::ALL_GREEN_VERDICT) {
       if (group.num_targets == 1) {
         cost += get_guess_cost(num_attempts_used);
       }
@@ -389,17 +1428,27 @@ double evaluate_guess(
       continue;
     }
 
+    if (searches_in_parallel && !best_guesses_by_verdict[verdict]) {
+      /* Skipped, since some other group is lost. */
+      span.record.cost = INFINITE_COST;
+      return INFINITE_COST;
+    }
     candidate_info best_guess =
-        find_best_guess(bank, cache, num_attempts_allowed, num_attempts_used,
-                        group, {}, get_guess_cost, pruning_policy);
+        searches_in_parallel
+            ? best_guesses_by_verdict[verdict].value()
+            : find_best_guess(bank, cache, num_attempts_allowed,
+                              num_attempts_used, group, {}, get_guess_cost,
+                              pruning_policy);
     if (callback_for_verdict_group) {
       callback_for_verdict_group(verdict, group, best_guess);
     }
     if (best_guess.cost >= INFINITE_COST) {
+      span.record.cost = INFINITE_COST;
       return INFINITE_COST;
     }
     cost += best_guess.cost;
   }
+  span.record.cost = cost;
   return cost;
 }
 
@@ -409,10 +1458,11 @@ struct guess_heuristic {
   double entropy;
 };
 
-guess_heuristic compute_guess_heuristic(const word_bank& bank,
-                                        const word_list& remaining_words,
+template <typename bank_type>
+guess_heuristic compute_guess_heuristic(const bank_type& bank,
+                                        word_list_view remaining_words,
                                         int guess) {
-  int num_targets_by_verdict[NUM_VERDICTS] = {};
+  int num_targets_by_verdict[bank_type::NUM_VERDICTS] = {};
   for (int i = 0; i < remaining_words.num_targets; i++) {
     int target = remaining_words.words[i];
     int verdict = bank.verdicts[guess][target];
@@ -420,7 +1470,7 @@ guess_heuristic compute_guess_heuristic(const word_bank& bank,
   }
 
   guess_heuristic heuristic = {};
-  for (int verdict = 0; verdict < NUM_VERDICTS; verdict++) {
+  for (int verdict = 0; verdict < bank_type::NUM_VERDICTS; verdict++) {
     int group_size = num_targets_by_verdict[verdict];
     if (group_size == 0) {
       continue;
@@ -434,13 +1484,17 @@ guess_heuristic compute_guess_heuristic(const word_bank& bank,
   return heuristic;
 }
 
-double compute_next_attempt_entropy(const word_bank& bank,
-                                    const word_list& remaining_words,
+template <typename bank_type>
+double compute_next_attempt_entropy(const bank_type& bank,
+                                    word_list_view remaining_words,
                                     int guess) {
-  static verdict_groups groups;
+  static thread_local std::unique_ptr<verdict_groups_for<bank_type>>
+      preallocated_groups =
+          std::make_unique_for_overwrite<verdict_groups_for<bank_type>>();
+  verdict_groups_for<bank_type>& groups = *preallocated_groups;
   group_remaining_words(groups, bank, remaining_words, guess, true);
   double entropy = 0.0;
-  for (word_list& group : groups) {
+  for (word_list_view group : groups) {
     if (group.num_targets == 0) {
       continue;
     }
@@ -461,13 +1515,678 @@ double compute_next_attempt_entropy(const word_bank& bank,
   return entropy;
 }
 
+/*
+  Lists the guesses worth evaluating for `remaining_words`, pruned by their
+  entropy (and two-attempt entropy) under `pruning`, in word list order
+*/
+template <typename bank_type>
+void find_candidates(word_list& out_candidates, const bank_type& bank,
+                     word_list_view remaining_words,
+                     candidate_pruning_key pruning) {
+  int max_entropy_place_to_consider = pruning.max_entropy_place_to_consider;
+  double max_entropy_difference_to_consider =
+      pruning.max_entropy_difference_to_consider;
+  bool prunes_by_two_attempt_entropy =
+      pruning.num_attempts_left_to_prune_by_two_attempt_entropy > 0;
+
+  struct candidate_heuristic {
+    int candidate;
+    int num_targets_in_largest_group;
+    double entropy;
+    double two_attempt_entropy;
+  };
+  static thread_local std::unique_ptr<candidate_heuristic[]>
+      preallocated_heuristics =
+          std::make_unique_for_overwrite<candidate_heuristic[]>(
+              MAX_BANK_SIZE);
+  candidate_heuristic* heuristics = preallocated_heuristics.get();
+  double max_candidate_entropy = 0.0;
+  for (int i = 0; i < remaining_words.num_words; i++) {
+    int candidate = remaining_words.words[i];
+    guess_heuristic heuristic =
+        compute_guess_heuristic(bank, remaining_words, candidate);
+    heuristics[i] = {
+        .candidate = candidate,
+        .num_targets_in_largest_group =
+            heuristic.num_targets_in_largest_verdict_group,
+        .entropy = heuristic.entropy,
+    };
+    max_candidate_entropy =
+        std::max(max_candidate_entropy, heuristic.entropy);
+  }
+
+  auto find_metric_at_place =
+      [](int num_heuristics, candidate_heuristic* heuristics, int place,
+         std::function<double(const candidate_heuristic& heuristic)>
+             get_metric) -> double {
+    candidate_heuristic* cutting_point = heuristics + place - 1;
+    std::nth_element(heuristics, cutting_point, heuristics + num_heuristics,
+                     [&get_metric](const candidate_heuristic& a,
+                                   const candidate_heuristic& b) -> bool {
+                       return get_metric(a) > get_metric(b);
+                     });
+    return get_metric(*cutting_point);
+  };
+  double min_entropy_to_consider =
+      max_candidate_entropy - max_entropy_difference_to_consider;
+  if (remaining_words.num_words > max_entropy_place_to_consider) {
+    double max_place_entropy = find_metric_at_place(
+        remaining_words.num_words, heuristics, max_entropy_place_to_consider,
+        [](const candidate_heuristic& heuristic) -> double {
+          return heuristic.entropy;
+        });
+    min_entropy_to_consider =
+        std::max(min_entropy_to_consider, max_place_entropy);
+  }
+
+  int max_entropy_place_to_consider_computing_two_attempt_entropy = std::min({
+      remaining_words.num_words,
+      remaining_words.num_targets * 4,
+      16 * max_entropy_place_to_consider,
+  });
+  double min_two_attempt_entropy_to_consider =
+      std::numeric_limits<double>::infinity();
+  if (prunes_by_two_attempt_entropy &&
+      remaining_words.num_words >
+          max_entropy_place_to_consider_computing_two_attempt_entropy) {
+    double min_entropy_to_consider_computing_two_attempt_entropy =
+        max_candidate_entropy - max_entropy_difference_to_consider;
+    if (remaining_words.num_words >
+        max_entropy_place_to_consider_computing_two_attempt_entropy) {
+      double max_place_entropy = find_metric_at_place(
+          remaining_words.num_words, heuristics,
+          max_entropy_place_to_consider_computing_two_attempt_entropy,
+          [](const candidate_heuristic& heuristics) -> double {
+            return heuristics.entropy;
+          });
+      min_entropy_to_consider_computing_two_attempt_entropy =
+          std::max(min_entropy_to_consider_computing_two_attempt_entropy,
+                   max_place_entropy);
+    }
+
+    int num_candidates_with_two_attempt_entropy_computed = 0;
+    double max_candidate_two_attempt_entropy = 0.0;
+    for (int i = 0; i < remaining_words.num_words; i++) {
+      candidate_heuristic& heuristic = heuristics[i];
+      if (heuristic.entropy >= min_entropy_to_consider) {
+        continue;
+      }
+      if (heuristic.entropy <
+          min_entropy_to_consider_computing_two_attempt_entropy) {
+        continue;
+      }
+      num_candidates_with_two_attempt_entropy_computed++;
+      double next_attempt_entropy = compute_next_attempt_entropy(
+          bank, remaining_words, heuristic.candidate);
+      heuristic.two_attempt_entropy =
+          heuristic.entropy + next_attempt_entropy;
+      max_candidate_two_attempt_entropy = std::max(
+          max_candidate_two_attempt_entropy, heuristic.two_attempt_entropy);
+    }
+    /* With none computed, there is no place to look at. */
+    if (num_candidates_with_two_attempt_entropy_computed > 0) {
+      double max_place_two_attempt_entropy = find_metric_at_place(
+          remaining_words.num_words, heuristics,
+          std::min(num_candidates_with_two_attempt_entropy_computed,
+                   max_entropy_place_to_consider),
+          [](const candidate_heuristic& heuristic) -> double {
+            return heuristic.two_attempt_entropy;
+          });
+      min_two_attempt_entropy_to_consider =
+          std::max(max_candidate_two_attempt_entropy -
+                       max_entropy_difference_to_consider,
+                   max_place_two_attempt_entropy);
+    }
+  }
+
+  out_candidates.num_words = 0;
+  for (int i = 0; i < remaining_words.num_words; i++) {
+    const candidate_heuristic& heuristic = heuristics[i];
+    if (heuristic.entropy < min_entropy_to_consider &&
+        heuristic.two_attempt_entropy < min_two_attempt_entropy_to_consider) {
+      continue;
+    }
+    out_candidates.words[out_candidates.num_words] = heuristic.candidate;
+    out_candidates.num_words++;
+  }
+}
+
+/*
+  The verdict groups each candidate splits the remaining targets into, with
+  groups labelled by the order in which their verdict first shows up, so that
+  equal partitions get equal labels whatever the verdicts are
+*/
+template <typename bank_type>
+struct candidate_partitions {
+  int num_targets;
+  /* `labels[c * num_targets + i]` => label of target i for candidate c */
+  std::vector<typename bank_type::verdict_type> labels;
+  /* `verdicts_by_label[c][label]` => verdict labelled `label` for c */
+  std::vector<std::vector<int>> verdicts_by_label;
+  /* `group_num_targets[c][label]` => number of targets in the group */
+  std::vector<std::vector<int>> group_num_targets;
+  /* -1 if the candidate is not one of the remaining targets */
+  std::vector<int> all_green_labels;
+  /*
+    `group_num_words[c][label]` and `group_hashes[c][label]` => size and
+    `hash_word_list` of the group word list (targets and guesses); filled in
+    on demand by `summarize_candidate_groups`
+  */
+  std::vector<std::vector<int>> group_num_words;
+  std::vector<std::vector<word_list_hash>> group_hashes;
+};
+
+template <typename bank_type>
+void label_candidate_partitions(candidate_partitions<bank_type>& out_partitions,
+                                const bank_type& bank,
+                                word_list_view remaining_words,
+                                word_list_view candidates) {
+  int num_candidates = candidates.num_words;
+  int num_targets = remaining_words.num_targets;
+  out_partitions.num_targets = num_targets;
+  out_partitions.labels.resize(num_candidates * num_targets);
+  out_partitions.verdicts_by_label.assign(num_candidates, {});
+  out_partitions.group_num_targets.assign(num_candidates, {});
+  out_partitions.all_green_labels.resize(num_candidates);
+  out_partitions.group_num_words.assign(num_candidates, {});
+  out_partitions.group_hashes.assign(num_candidates, {});
+  int label_by_verdict[bank_type::NUM_VERDICTS];
+  std::fill_n(label_by_verdict, bank_type::NUM_VERDICTS, -1);
+  for (int c = 0; c < num_candidates; c++) {
+    int guess = candidates.words[c];
+    std::vector<int>& verdicts_by_label = out_partitions.verdicts_by_label[c];
+    std::vector<int>& group_num_targets = out_partitions.group_num_targets[c];
+    for (int i = 0; i < num_targets; i++) {
+      int verdict = bank.verdicts[guess][remaining_words.words[i]];
+      if (label_by_verdict[verdict] == -1) {
+        label_by_verdict[verdict] = verdicts_by_label.size();
+        verdicts_by_label.push_back(verdict);
+        group_num_targets.push_back(0);
+      }
+      out_partitions.labels[c * num_targets + i] = label_by_verdict[verdict];
+      group_num_targets[label_by_verdict[verdict]]++;
+    }
+    out_partitions.all_green_labels[c] =
+        label_by_verdict[bank_type::ALL_GREEN_VERDICT];
+    for (int verdict : verdicts_by_label) {
+      label_by_verdict[verdict] = -1;
+    }
+  }
+}
+
+/*
+  Groups of at most two targets cost the same whatever words are left to
+  guess in them (see `find_best_guess`), so only larger groups are summarized
+*/
+constexpr int MIN_NUM_TARGETS_TO_COMPARE_GROUP_WORDS = 3;
+
+template <typename bank_type>
+void summarize_candidate_groups(candidate_partitions<bank_type>& partitions,
+                                const bank_type& bank,
+                                word_list_view remaining_words,
+                                word_list_view candidates, int c) {
+  if (!partitions.group_num_words[c].empty()) {
+    return;
+  }
+  static thread_local std::unique_ptr<verdict_groups_for<bank_type>>
+      preallocated_groups =
+          std::make_unique_for_overwrite<verdict_groups_for<bank_type>>();
+  verdict_groups_for<bank_type>& groups = *preallocated_groups;
+  group_remaining_words(groups, bank, remaining_words, candidates.words[c]);
+  for (int verdict : partitions.verdicts_by_label[c]) {
+    word_list_view group = groups[verdict];
+    bool is_summarized =
+        group.num_targets >= MIN_NUM_TARGETS_TO_COMPARE_GROUP_WORDS;
+    partitions.group_num_words[c].push_back(is_summarized ? group.num_words
+                                                          : 0);
+    partitions.group_hashes[c].push_back(
+        is_summarized ? hash_word_list(group) : word_list_hash{});
+  }
+}
+
+/*
+  Guesses that split the remaining targets into the same verdict groups, with
+  the same words left guessable in each group, cost exactly the same. Sets
+  `out_representatives[c]` to the index of the first candidate equivalent to
+  candidate c (which is `c` itself if there is none), so that only one
+  candidate of each kind needs to be evaluated.
+*/
+template <typename bank_type>
+void find_equivalent_candidates(std::vector<int>& out_representatives,
+                                candidate_partitions<bank_type>& partitions,
+                                const bank_type& bank,
+                                word_list_view remaining_words,
+                                word_list_view candidates) {
+  int num_candidates = candidates.num_words;
+  int num_targets = partitions.num_targets;
+  out_representatives.resize(num_candidates);
+  std::iota(out_representatives.begin(), out_representatives.end(), 0);
+
+  std::vector<std::pair<uint64_t, int>> signatures(num_candidates);
+  for (int c = 0; c < num_candidates; c++) {
+    uint64_t signature = 0;
+    for (int i = 0; i < num_targets; i++) {
+      signature = signature * 31 + partitions.labels[c * num_targets + i];
+    }
+    signatures[c] = {signature * 31 + partitions.all_green_labels[c], c};
+  }
+  std::sort(signatures.begin(), signatures.end());
+
+  auto are_equivalent = [&](int a, int b) -> bool {
+    if (partitions.all_green_labels[a] != partitions.all_green_labels[b] ||
+        !std::equal(partitions.labels.begin() + a * num_targets,
+                    partitions.labels.begin() + (a + 1) * num_targets,
+                    partitions.labels.begin() + b * num_targets)) {
+      return false;
+    }
+    const std::vector<int>& group_num_targets =
+        partitions.group_num_targets[a];
+    if (std::none_of(group_num_targets.begin(), group_num_targets.end(),
+                     [](int num_targets) -> bool {
+                       return num_targets >=
+                              MIN_NUM_TARGETS_TO_COMPARE_GROUP_WORDS;
+                     })) {
+      return true;
+    }
+    summarize_candidate_groups(partitions, bank, remaining_words, candidates,
+                               a);
+    summarize_candidate_groups(partitions, bank, remaining_words, candidates,
+                               b);
+    return partitions.group_hashes[a] == partitions.group_hashes[b];
+  };
+
+  for (int run_start = 0, run_end; run_start < num_candidates;
+       run_start = run_end) {
+    run_end = run_start + 1;
+    while (run_end < num_candidates &&
+           signatures[run_end].first == signatures[run_start].first) {
+      run_end++;
+    }
+    for (int i = run_start + 1; i < run_end; i++) {
+      int c = signatures[i].second;
+      for (int j = run_start; j < i; j++) {
+        int other = signatures[j].second;
+        if (out_representatives[other] == other && are_equivalent(other, c)) {
+          out_representatives[c] = other;
+          break;
+        }
+      }
+    }
+  }
+}
+
+/*
+  In an exact search, a candidate can never beat another one that splits each
+  of its verdict groups further while leaving at least the same words
+  guessable in every resulting group: any strategy for one of its groups also
+  solves every smaller group, at no more cost. The entropy pruning of
+  `find_candidates` below them may still find the coarser candidate a cheaper
+  strategy, so dropping it is part of the heuristic. Candidates that are
+  remaining targets are never dominated, since solving their own group takes
+  one attempt less. Sets `out_dominators[c]`, for every representative
+  candidate (as found by `find_equivalent_candidates`) dominated by an earlier
+  representative, to the earliest undominated one dominating it, and to -1
+  for every other candidate. Only earlier candidates dominate, so that ties
+  still go to the earliest candidate.
+*/
+template <typename bank_type>
+void find_dominated_candidates(std::vector<int>& out_dominators,
+                               candidate_partitions<bank_type>& partitions,
+                               const bank_type& bank,
+                               word_list_view remaining_words,
+                               word_list_view candidates,
+                               const std::vector<int>& representatives) {
+  int num_candidates = candidates.num_words;
+  int num_targets = partitions.num_targets;
+  out_dominators.assign(num_candidates, -1);
+
+  auto is_guessable_in_group = [&bank, &remaining_words](
+                                   int guess, int verdict,
+                                   const auto& is_hard_mode_valid_candidate,
+                                   int i) -> bool {
+    int candidate = remaining_words.words[i];
+    if (i < remaining_words.num_targets &&
+        bank.verdicts[guess][candidate] == verdict) {
+      return true;
+    }
+    return is_hard_mode_valid_candidate(candidate);
+  };
+  std::vector<int> coarse_label_by_label;
+  std::vector<int> labels_to_check;
+  auto is_dominated_by = [&](int a, int b) -> bool {
+    const std::vector<int>& coarse_verdicts = partitions.verdicts_by_label[a];
+    const std::vector<int>& fine_verdicts = partitions.verdicts_by_label[b];
+    if (partitions.all_green_labels[a] != -1 ||
+        coarse_verdicts.size() > fine_verdicts.size()) {
+      return false;
+    }
+    coarse_label_by_label.assign(fine_verdicts.size(), -1);
+    for (int i = 0; i < num_targets; i++) {
+      int coarse_label = partitions.labels[a * num_targets + i];
+      int& expected_coarse_label =
+          coarse_label_by_label[partitions.labels[b * num_targets + i]];
+      if (expected_coarse_label == -1) {
+        expected_coarse_label = coarse_label;
+      } else if (expected_coarse_label != coarse_label) {
+        return false;
+      }
+    }
+
+    /*
+      A group left with as many words as the coarser one must hold the very
+      same words; only larger groups need to be checked word by word.
+    */
+    labels_to_check.clear();
+    for (int label = 0; label < fine_verdicts.size(); label++) {
+      if (partitions.group_num_targets[b][label] <
+          MIN_NUM_TARGETS_TO_COMPARE_GROUP_WORDS) {
+        continue;
+      }
+      summarize_candidate_groups(partitions, bank, remaining_words, candidates,
+                                 a);
+      summarize_candidate_groups(partitions, bank, remaining_words, candidates,
+                                 b);
+      int coarse_label = coarse_label_by_label[label];
+      int fine_num_words = partitions.group_num_words[b][label];
+      int coarse_num_words = partitions.group_num_words[a][coarse_label];
+      if (fine_num_words < coarse_num_words ||
+          (fine_num_words == coarse_num_words &&
+           partitions.group_hashes[b][label] !=
+               partitions.group_hashes[a][coarse_label])) {
+        return false;
+      }
+      if (fine_num_words > coarse_num_words) {
+        labels_to_check.push_back(label);
+      }
+    }
+    for (int label : labels_to_check) {
+      int coarse_guess = candidates.words[a];
+      int coarse_verdict = coarse_verdicts[coarse_label_by_label[label]];
+      int fine_guess = candidates.words[b];
+      int fine_verdict = fine_verdicts[label];
+      auto is_coarse_hard_mode_valid_candidate =
+          make_hard_mode_validity_check(bank, coarse_guess, coarse_verdict);
+      auto is_fine_hard_mode_valid_candidate =
+          make_hard_mode_validity_check(bank, fine_guess, fine_verdict);
+      for (int i = 0; i < remaining_words.num_words; i++) {
+        if (is_guessable_in_group(coarse_guess, coarse_verdict,
+                                  is_coarse_hard_mode_valid_candidate, i) &&
+            !is_guessable_in_group(fine_guess, fine_verdict,
+                                   is_fine_hard_mode_valid_candidate, i)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  for (int a = 0; a < num_candidates; a++) {
+    if (representatives[a] != a) {
+      continue;
+    }
+    for (int b = 0; b < a; b++) {
+      if (representatives[b] == b && is_dominated_by(a, b)) {
+        /* Dominance is transitive, and `b` was settled already. */
+        out_dominators[a] = out_dominators[b] == -1 ? b : out_dominators[b];
+        break;
+      }
+    }
+  }
+}
+
+struct cost_estimate {
+  double cost;
+  /* Half the width of the 95% confidence interval around `cost` */
+  double margin;
+  int num_samples;
+};
+
+/* The word of highest entropy, the earliest one (thus a target) on ties */
+template <typename bank_type>
+static int find_greedy_guess(const bank_type& bank,
+                             word_list_view remaining_words) {
+  if (remaining_words.num_targets <= 2) {
+    return remaining_words.words[0];
+  }
+  int best_guess = remaining_words.words[0];
+  double best_entropy = -1.0;
+  for (int i = 0; i < remaining_words.num_words; i++) {
+    int guess = remaining_words.words[i];
+    double entropy =
+        compute_guess_heuristic(bank, remaining_words, guess).entropy;
+    if (entropy > best_entropy) {
+      best_guess = guess;
+      best_entropy = entropy;
+    }
+  }
+  return best_guess;
+}
+
+/*
+  Plays `guess` against `target` and then greedy guesses (see
+  `find_greedy_guess`) until it is solved, narrowing `remaining_words` down;
+  a game that is not won costs as much as winning one attempt too late
+*/
+template <typename bank_type>
+static double play_out_greedily(const bank_type& bank,
+                                int num_attempts_allowed,
+                                int num_attempts_used,
+                                word_list& remaining_words, int guess,
+                                int target,
+                                guess_cost_function get_guess_cost) {
+  while (guess != target) {
+    if (num_attempts_used == num_attempts_allowed) {
+      return get_guess_cost(num_attempts_allowed + 1);
+    }
+    apply_verdict(remaining_words, bank, guess, bank.verdicts[guess][target]);
+    guess = find_greedy_guess(bank, remaining_words);
+    num_attempts_used++;
+  }
+  return get_guess_cost(num_attempts_used);
+}
+
+/*
+  Estimates what `evaluate_guess` returns, far faster on large states: verdict
+  groups of at most two targets are costed exactly, and `num_samples` targets
+  of the larger groups, drawn at random from `seed`, are played out greedily
+  (see `play_out_greedily`). Greedy play is no better than a search, so
+  estimates lean high. If the larger groups have no more than `num_samples`
+  targets, every one of them is played out once instead, with no margin.
+*/
+template <typename bank_type>
+cost_estimate estimate_guess_cost(
+    const bank_type& bank, int num_attempts_allowed, int num_attempts_used,
+    word_list_view remaining_words, int guess, int num_samples, uint64_t seed,
+    guess_cost_function get_guess_cost = get_flat_guess_cost) {
+  if (remaining_words.num_targets == 1 && guess == remaining_words.words[0]) {
+    return {.cost = get_guess_cost(num_attempts_used)};
+  }
+  if (num_attempts_used == num_attempts_allowed) {
+    return {.cost = INFINITE_COST};
+  }
+
+  static thread_local std::unique_ptr<verdict_groups_for<bank_type>>
+      preallocated_groups =
+          std::make_unique_for_overwrite<verdict_groups_for<bank_type>>();
+  static thread_local std::unique_ptr<word_list> preallocated_played_words =
+      std::make_unique_for_overwrite<word_list>();
+  verdict_groups_for<bank_type>& groups = *preallocated_groups;
+  word_list& played_words = *preallocated_played_words;
+  group_remaining_words(groups, bank, remaining_words, guess);
+
+  double exact_cost = 0.0;
+  /* Verdicts of the larger groups, with the number of targets before each */
+  std::vector<int> sampled_verdicts;
+  std::vector<int> num_targets_before;
+  int num_sampled_targets = 0;
+  for (int verdict = 0; verdict < bank_type::NUM_VERDICTS; verdict++) {
+    word_list_view group = groups[verdict];
+    if (group.num_targets == 0) {
+      continue;
+    }
+    if (verdict == bank_type::ALL_GREEN_VERDICT) {
+      exact_cost += get_guess_cost(num_attempts_used);
+    } else if (group.num_targets == 1) {
+      exact_cost += get_guess_cost(num_attempts_used + 1);
+    } else if (group.num_targets == 2) {
+      exact_cost += num_attempts_used == num_attempts_allowed - 1
+                        ? INFINITE_COST
+                        : get_guess_cost(num_attempts_used + 1) +
+                              get_guess_cost(num_attempts_used + 2);
+    } else {
+      sampled_verdicts.push_back(verdict);
+      num_targets_before.push_back(num_sampled_targets);
+      num_sampled_targets += group.num_targets;
+    }
+  }
+  if (num_sampled_targets == 0 || exact_cost >= INFINITE_COST) {
+    return {.cost = exact_cost};
+  }
+
+  bool plays_every_target = num_sampled_targets <= num_samples;
+  int num_plays = plays_every_target ? num_sampled_targets : num_samples;
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<int> pick_target(0, num_sampled_targets - 1);
+  /* The first greedy guess of a group does not depend on the target. */
+  std::vector<int> first_greedy_guesses(sampled_verdicts.size(), -1);
+  double sum = 0.0;
+  double sum_of_squares = 0.0;
+  for (int i = 0; i < num_plays; i++) {
+    int t = plays_every_target ? i : pick_target(rng);
+    int g = std::upper_bound(num_targets_before.begin(),
+                             num_targets_before.end(), t) -
+            num_targets_before.begin() - 1;
+    word_list_view group = groups[sampled_verdicts[g]];
+    if (first_greedy_guesses[g] == -1) {
+      first_greedy_guesses[g] = find_greedy_guess(bank, group);
+    }
+    copy_word_list(played_words, group);
+    double cost = play_out_greedily(
+        bank, num_attempts_allowed, num_attempts_used + 1, played_words,
+        first_greedy_guesses[g], group.words[t - num_targets_before[g]],
+        get_guess_cost);
+    sum += cost;
+    sum_of_squares += cost * cost;
+  }
+  if (plays_every_target) {
+    return {.cost = exact_cost + sum, .num_samples = num_plays};
+  }
+  double mean = sum / num_plays;
+  double variance =
+      std::max(sum_of_squares / num_plays - mean * mean, 0.0) *
+      num_plays / std::max(num_plays - 1, 1);
+  return {
+      .cost = exact_cost + mean * num_sampled_targets,
+      .margin = 1.96 * std::sqrt(variance / num_plays) * num_sampled_targets,
+      .num_samples = num_plays,
+  };
+}
+
+/*
+  Lists the candidates `find_best_guess` evaluates for `remaining_words` after
+  `num_attempts_used` attempts, in the order it evaluates them, leaving out
+  those equivalent to or dominated by an earlier candidate
+*/
+template <typename bank_type>
+void find_candidates_to_evaluate(word_list& out_candidates,
+                                 const bank_type& bank, int num_attempts_used,
+                                 word_list_view remaining_words,
+                                 candidate_pruning_policy pruning_policy) {
+  static thread_local std::unique_ptr<word_list> preallocated_candidates =
+      std::make_unique_for_overwrite<word_list>();
+  word_list& candidates = *preallocated_candidates;
+  find_candidates(
+      candidates, bank, remaining_words,
+      get_candidate_pruning_key(pruning_policy, num_attempts_used));
+
+  candidate_partitions<bank_type> partitions;
+  label_candidate_partitions(partitions, bank, remaining_words, candidates);
+  std::vector<int> representatives;
+  find_equivalent_candidates(representatives, partitions, bank,
+                             remaining_words, candidates);
+  std::vector<int> dominators;
+  find_dominated_candidates(dominators, partitions, bank, remaining_words,
+                            candidates, representatives);
+
+  out_candidates.num_words = 0;
+  out_candidates.num_targets = 0;
+  for (int i = 0; i < candidates.num_words; i++) {
+    if (representatives[i] == i && dominators[i] == -1) {
+      out_candidates.words[out_candidates.num_words] = candidates.words[i];
+      out_candidates.num_words++;
+    }
+  }
+}
+
+/*
+  Counts the targets solved by each attempt of the strategy `find_best_guess`
+  caches once it picks `guess`: playing it, then the best guesses cached for
+  its verdict groups. Returns `std::nullopt` if those are not all counted,
+  e.g. when some were preloaded from an opening book.
+*/
+template <typename bank_type>
+static std::optional<std::array<int, MAX_NUM_ATTEMPTS_ALLOWED>>
+count_targets_solved_by_attempts_used(
+    const bank_type& bank, bot_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, word_list_view remaining_words, int guess,
+    const guess_cost_function& get_guess_cost,
+    candidate_pruning_policy pruning_policy) {
+  static thread_local std::unique_ptr<verdict_groups_for<bank_type>>
+      preallocated_groups =
+          std::make_unique_for_overwrite<verdict_groups_for<bank_type>>();
+  verdict_groups_for<bank_type>& groups = *preallocated_groups;
+  group_remaining_words(groups, bank, remaining_words, guess);
+
+  std::array<int, MAX_NUM_ATTEMPTS_ALLOWED> num_targets_solved = {};
+  int num_attempts_left = num_attempts_allowed - num_attempts_used - 1;
+  for (int verdict = 0; verdict < bank_type::NUM_VERDICTS; verdict++) {
+    word_list_view group = groups[verdict];
+    if (group.num_targets == 0) {
+      continue;
+    }
+    if (verdict == bank_type::ALL_GREEN_VERDICT) {
+      num_targets_solved[0]++;
+      continue;
+    }
+    /* As `find_best_guess` solves groups of 1 or 2 targets */
+    if (group.num_targets == 1) {
+      num_targets_solved[1]++;
+      continue;
+    }
+    if (num_attempts_left == 1) {
+      return std::nullopt;
+    }
+    if (group.num_targets == 2) {
+      num_targets_solved[1]++;
+      num_targets_solved[2]++;
+      continue;
+    }
+    double depth_cost;
+    find_best_guess_cache_key cache_key = make_find_best_guess_cache_key(
+        depth_cost, bank, num_attempts_used + 1, group, get_guess_cost,
+        pruning_policy);
+    std::shared_lock lock(cache.mutex);
+    const cached_best_guess* cached =
+        find_cached_best_guess(cache, num_attempts_left, cache_key);
+    if (cached == nullptr ||
+        !cached->num_targets_solved_by_attempts_used.has_value()) {
+      return std::nullopt;
+    }
+    for (int k = 0; k + 1 < MAX_NUM_ATTEMPTS_ALLOWED; k++) {
+      num_targets_solved[k + 1] +=
+          cached->num_targets_solved_by_attempts_used.value()[k];
+    }
+  }
+  return num_targets_solved;
+}
+
+template <typename bank_type>
 candidate_info find_best_guess(
-    const word_bank& bank, bot_cache& cache, int num_attempts_allowed,
-    int num_attempts_used, const word_list& remaining_words,
-    find_best_guess_callback_for_candidate callback_for_candidate = {},
-    guess_cost_function get_guess_cost = get_flat_guess_cost,
-    candidate_pruning_policy pruning_policy =
-        default_candidate_pruning_policy) {
+    const bank_type& bank, bot_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, word_list_view remaining_words,
+    find_best_guess_callback_for_candidate callback_for_candidate,
+    guess_cost_function get_guess_cost,
+    candidate_pruning_policy pruning_policy) {
   if (remaining_words.num_targets == 1) {
     return candidate_info{
         .guess = remaining_words.words[0],
@@ -488,177 +2207,192 @@ candidate_info find_best_guess(
     };
   }
 
-  word_list_hash remaining_words_hash = hash_word_list(remaining_words);
-  find_best_guess_cache_key cache_key = {
-      .bank_hash = bank.hash,
-      .remaining_words_hash = remaining_words_hash,
-      .get_guess_cost = get_guess_cost,
-      .max_entropy_place_to_consider_pruning =
-          num_attempts_used == 0 &&
-                  pruning_policy
-                      .max_entropy_place_to_consider_for_initial_attempt
-                      .has_value()
-              ? pruning_policy.max_entropy_place_to_consider_for_initial_attempt
-                    .value()
-              : pruning_policy.max_entropy_place_to_consider};
+  search_timeline_span span(cache.timeline, "find_best_guess",
+                            num_attempts_used, remaining_words.num_words,
+                            remaining_words.num_targets, nullptr);
+  double depth_cost;
+  find_best_guess_cache_key cache_key = make_find_best_guess_cache_key(
+      depth_cost, bank, num_attempts_used, remaining_words, get_guess_cost,
+      pruning_policy);
   find_best_guess_cache& result_cache =
-      cache.find_best_guess_cache_by_attempts_allowed_and_used
-          [num_attempts_allowed - 1][num_attempts_used];
-  if (auto it = result_cache.find(cache_key); it != result_cache.end()) {
-    return it->second;
-  }
-
-  auto find_candidates = [](word_list& out_candidates, const word_bank& bank,
-                            int num_attempts_used,
-                            const word_list& remaining_words,
-                            candidate_pruning_policy pruning_policy) -> void {
-    constexpr int MAX_NUM_ATTEMPTS_USED_TO_PRUNE_BY_TWO_ATTEMPT_ENTROPY = 1;
-    int max_entropy_place_to_consider =
-        pruning_policy.max_entropy_place_to_consider;
-    if (num_attempts_used == 0 &&
-        pruning_policy.max_entropy_place_to_consider_for_initial_attempt
-            .has_value()) {
-      max_entropy_place_to_consider =
-          pruning_policy.max_entropy_place_to_consider_for_initial_attempt
-              .value();
-    } else if (num_attempts_used <=
-               MAX_NUM_ATTEMPTS_USED_TO_PRUNE_BY_TWO_ATTEMPT_ENTROPY) {
-      max_entropy_place_to_consider =
-          std::max(max_entropy_place_to_consider / 2, 1);
-    }
-    double max_entropy_difference_to_consider = 1.0;
-
-    struct candidate_heuristic {
-      int candidate;
-      int num_targets_in_largest_group;
-      double entropy;
-      double two_attempt_entropy;
-    };
-    static candidate_heuristic heuristics[MAX_BANK_SIZE];
-    double max_candidate_entropy = 0.0;
-    for (int i = 0; i < remaining_words.num_words; i++) {
-      int candidate = remaining_words.words[i];
-      guess_heuristic heuristic =
-          compute_guess_heuristic(bank, remaining_words, candidate);
-      heuristics[i] = {
-          .candidate = candidate,
-          .num_targets_in_largest_group =
-              heuristic.num_targets_in_largest_verdict_group,
-          .entropy = heuristic.entropy,
+      cache.find_best_guess_cache_by_attempts_left[num_attempts_allowed -
+                                                   num_attempts_used - 1];
+  {
+    std::shared_lock lock(cache.mutex);
+    const cached_best_guess* cached = find_cached_best_guess(
+        cache, num_attempts_allowed - num_attempts_used, cache_key);
+    if (cached != nullptr) {
+      cache.stats.num_cache_hits.fetch_add(1, std::memory_order_relaxed);
+      candidate_info best_guess = {
+          .guess = find_word_by_root_word(bank, cached->guess),
+          .cost = cached->cost + depth_cost,
       };
-      max_candidate_entropy =
-          std::max(max_candidate_entropy, heuristic.entropy);
-    }
-
-    auto find_metric_at_place =
-        [](int num_heuristics, candidate_heuristic* heuristics, int place,
-           std::function<double(const candidate_heuristic& heuristic)>
-               get_metric) -> double {
-      candidate_heuristic* cutting_point = heuristics + place - 1;
-      std::nth_element(heuristics, cutting_point, heuristics + num_heuristics,
-                       [&get_metric](const candidate_heuristic& a,
-                                     const candidate_heuristic& b) -> bool {
-                         return get_metric(a) > get_metric(b);
-                       });
-      return get_metric(*cutting_point);
-    };
-    double min_entropy_to_consider =
-        max_candidate_entropy - max_entropy_difference_to_consider;
-    if (remaining_words.num_words > max_entropy_place_to_consider) {
-      double max_place_entropy = find_metric_at_place(
-          remaining_words.num_words, heuristics, max_entropy_place_to_consider,
-          [](const candidate_heuristic& heuristic) -> double {
-            return heuristic.entropy;
-          });
-      min_entropy_to_consider =
-          std::max(min_entropy_to_consider, max_place_entropy);
-    }
-
-    int max_entropy_place_to_consider_computing_two_attempt_entropy = std::min({
-        remaining_words.num_words,
-        remaining_words.num_targets * 4,
-        16 * max_entropy_place_to_consider,
-    });
-    double min_two_attempt_entropy_to_consider =
-        std::numeric_limits<double>::infinity();
-    if (num_attempts_used <=
-            MAX_NUM_ATTEMPTS_USED_TO_PRUNE_BY_TWO_ATTEMPT_ENTROPY &&
-        remaining_words.num_words >
-            max_entropy_place_to_consider_computing_two_attempt_entropy) {
-      double min_entropy_to_consider_computing_two_attempt_entropy =
-          max_candidate_entropy - max_entropy_difference_to_consider;
-      if (remaining_words.num_words >
-          max_entropy_place_to_consider_computing_two_attempt_entropy) {
-        double max_place_entropy = find_metric_at_place(
-            remaining_words.num_words, heuristics,
-            max_entropy_place_to_consider_computing_two_attempt_entropy,
-            [](const candidate_heuristic& heuristics) -> double {
-              return heuristics.entropy;
-            });
-        min_entropy_to_consider_computing_two_attempt_entropy =
-            std::max(min_entropy_to_consider_computing_two_attempt_entropy,
-                     max_place_entropy);
-      }
+      span.record.is_cache_hit = true;
+      span.set_result(get_word_letters(bank, best_guess.guess),
+                      best_guess.cost);
+      return best_guess;
+    }
+  }
 
-      int num_candidates_with_two_attempt_entropy_computed = 0;
-      double max_candidate_two_attempt_entropy = 0.0;
-      for (int i = 0; i < remaining_words.num_words; i++) {
-        candidate_heuristic& heuristic = heuristics[i];
-        if (heuristic.entropy >= min_entropy_to_consider) {
-          continue;
-        }
-        if (heuristic.entropy <
-            min_entropy_to_consider_computing_two_attempt_entropy) {
-          continue;
-        }
-        num_candidates_with_two_attempt_entropy_computed++;
-        double next_attempt_entropy = compute_next_attempt_entropy(
-            bank, remaining_words, heuristic.candidate);
-        heuristic.two_attempt_entropy =
-            heuristic.entropy + next_attempt_entropy;
-        max_candidate_two_attempt_entropy = std::max(
-            max_candidate_two_attempt_entropy, heuristic.two_attempt_entropy);
-      }
-      double max_place_two_attempt_entropy = find_metric_at_place(
-          remaining_words.num_words, heuristics,
-          std::min(num_candidates_with_two_attempt_entropy_computed,
-                   max_entropy_place_to_consider),
-          [](const candidate_heuristic& heuristic) -> double {
-            return heuristic.two_attempt_entropy;
+  if constexpr (!bank_type::IS_SUB_BANK) {
+    if (remaining_words.num_words <= MAX_SUB_BANK_SIZE &&
+        remaining_words.num_words <=
+            remaining_words.num_targets * MAX_NUM_SUB_BANK_WORDS_PER_TARGET) {
+      using sub_bank_type = basic_sub_bank<bank_type>;
+      /*
+        Recycled, since a callback may start another search reaching a sub
+        bank before this one is done.
+      */
+      recycled_buffer<sub_bank_type> recycled_sub_bank;
+      recycled_buffer<word_list> recycled_sub_bank_remaining_words;
+      sub_bank_type& sub_bank = *recycled_sub_bank;
+      word_list& sub_bank_remaining_words = *recycled_sub_bank_remaining_words;
+      load_sub_bank(sub_bank, sub_bank_remaining_words, bank, remaining_words);
+      span.drop();
+      find_best_guess_callback_for_candidate sub_bank_callback_for_candidate;
+      if (callback_for_candidate) {
+        sub_bank_callback_for_candidate =
+            [&sub_bank,
+             &callback_for_candidate](candidate_info candidate) -> void {
+          callback_for_candidate(candidate_info{
+              .guess = sub_bank.root_words[candidate.guess],
+              .cost = candidate.cost,
           });
-      min_two_attempt_entropy_to_consider =
-          std::max(max_candidate_two_attempt_entropy -
-                       max_entropy_difference_to_consider,
-                   max_place_two_attempt_entropy);
+        };
+      }
+      candidate_info best_guess = find_best_guess(
+          sub_bank, cache, num_attempts_allowed, num_attempts_used,
+          sub_bank_remaining_words, sub_bank_callback_for_candidate,
+          get_guess_cost, pruning_policy);
+      return candidate_info{
+          .guess = sub_bank.root_words[best_guess.guess],
+          .cost = best_guess.cost,
+      };
     }
+  }
 
-    out_candidates.num_words = 0;
-    for (int i = 0; i < remaining_words.num_words; i++) {
-      const candidate_heuristic& heuristic = heuristics[i];
-      if (heuristic.entropy < min_entropy_to_consider &&
-          heuristic.two_attempt_entropy < min_two_attempt_entropy_to_consider) {
+  cache.stats.num_nodes_searched.fetch_add(1, std::memory_order_relaxed);
+
+  bool searches_in_parallel = should_search_in_parallel(bank, remaining_words);
+  static thread_local std::unique_ptr<word_list[]>
+      preallocated_candidates_by_attempts_used =
+          std::make_unique_for_overwrite<word_list[]>(MAX_NUM_ATTEMPTS_ALLOWED);
+  /*
+    Tasks run while waiting, and searches started by the callback, may reach
+    the same attempt on this thread while the candidates are still in use.
+  */
+  std::optional<recycled_buffer<word_list>> recycled_candidates;
+  word_list& candidates =
+      searches_in_parallel || callback_for_candidate
+          ? *recycled_candidates.emplace()
+          : preallocated_candidates_by_attempts_used[num_attempts_used];
+  find_candidates(candidates, bank, remaining_words, cache_key.pruning);
+  span.record.num_candidates = candidates.num_words;
+
+  candidate_partitions<bank_type> partitions;
+  label_candidate_partitions(partitions, bank, remaining_words, candidates);
+  std::vector<int> representatives;
+  find_equivalent_candidates(representatives, partitions, bank,
+                             remaining_words, candidates);
+  std::vector<int> dominators;
+  find_dominated_candidates(dominators, partitions, bank, remaining_words,
+                            candidates, representatives);
+  /* Left out of the search, and of what the callback hears about */
+  std::vector<bool> is_ranked_out(candidates.num_words, false);
+  auto is_evaluated = [&representatives, &dominators,
+                       &is_ranked_out](int i) -> bool {
+    return representatives[i] == i && dominators[i] == -1 && !is_ranked_out[i];
+  };
+  if (pruning_policy.min_num_targets_to_estimate.has_value() &&
+      remaining_words.num_targets >=
+          pruning_policy.min_num_targets_to_estimate.value()) {
+    std::vector<double> estimated_costs(candidates.num_words);
+    std::vector<int> ranked_candidates;
+    auto estimate_candidate = [&](int i) -> void {
+      estimated_costs[i] =
+          estimate_guess_cost(bank, num_attempts_allowed,
+                              num_attempts_used + 1, remaining_words,
+                              candidates.words[i],
+                              pruning_policy.num_estimation_samples,
+                              cache_key.remaining_words_hash[0] +
+                                  get_root_word(bank, candidates.words[i]),
+                              get_guess_cost)
+              .cost;
+    };
+    /*
+      Only a frame searching in parallel holds buffers of its own while it
+      waits; any other one estimates on the spot.
+    */
+    task_group tasks;
+    for (int i = candidates.num_words - 1; i >= 0; i--) {
+      if (!is_evaluated(i)) {
         continue;
       }
-      out_candidates.words[out_candidates.num_words] = heuristic.candidate;
-      out_candidates.num_words++;
+      ranked_candidates.push_back(i);
+      if (searches_in_parallel) {
+        spawn_task(tasks, [&estimate_candidate, i]() -> void {
+          estimate_candidate(i);
+        });
+      } else {
+        estimate_candidate(i);
+      }
     }
-  };
-  static word_list
-      preallocated_candidates_by_attempts_used[MAX_NUM_ATTEMPTS_ALLOWED];
-  word_list& candidates =
-      preallocated_candidates_by_attempts_used[num_attempts_used];
-  find_candidates(candidates, bank, num_attempts_used, remaining_words,
-                  pruning_policy);
+    if (searches_in_parallel) {
+      wait_for_tasks(tasks);
+    }
+    std::sort(ranked_candidates.begin(), ranked_candidates.end(),
+              [&estimated_costs](int a, int b) -> bool {
+                return estimated_costs[a] != estimated_costs[b]
+                           ? estimated_costs[a] < estimated_costs[b]
+                           : a < b;
+              });
+    for (int r = pruning_policy.max_num_candidates_to_evaluate_after_estimation;
+         r < ranked_candidates.size(); r++) {
+      is_ranked_out[ranked_candidates[r]] = true;
+    }
+  }
 
   candidate_info best_guess = {
       .guess = remaining_words.words[0],
       .cost = INFINITE_COST,
   };
+  std::vector<double> costs(candidates.num_words);
+  auto evaluate_candidate = [&](int i) -> void {
+    cache.stats.num_guesses_evaluated.fetch_add(1, std::memory_order_relaxed);
+    costs[i] = evaluate_guess(bank, cache, num_attempts_allowed,
+                              num_attempts_used + 1, remaining_words,
+                              candidates.words[i], {}, get_guess_cost,
+                              pruning_policy);
+  };
+  if (searches_in_parallel) {
+    task_group tasks;
+    /* Spawned in reverse, so that this thread takes them in order. */
+    for (int i = candidates.num_words - 1; i >= 0; i--) {
+      if (is_evaluated(i)) {
+        spawn_task(tasks, [&evaluate_candidate, i]() -> void {
+          evaluate_candidate(i);
+        });
+      }
+    }
+    wait_for_tasks(tasks);
+  }
+  /*
+    Ties go to the earliest candidate however the costs were computed.
+    Dominated candidates are reported at the cost of their dominator, which
+    comes earlier and so wins any tie.
+  */
   for (int i = 0; i < candidates.num_words; i++) {
+    int evaluated = dominators[representatives[i]] == -1
+                        ? representatives[i]
+                        : dominators[representatives[i]];
+    if (is_ranked_out[evaluated]) {
+      continue;
+    }
     int guess = candidates.words[i];
-    double cost = evaluate_guess(bank, cache, num_attempts_allowed,
-                                 num_attempts_used + 1, remaining_words, guess,
-                                 {}, get_guess_cost, pruning_policy);
+    if (evaluated == i && !searches_in_parallel) {
+      evaluate_candidate(i);
+    }
+    double cost = costs[evaluated];
     if (callback_for_candidate) {
       callback_for_candidate(candidate_info{
           .guess = guess,
@@ -673,10 +2407,66 @@ candidate_info find_best_guess(
     }
   }
 
-  result_cache[cache_key] = best_guess;
+  std::optional<std::array<int, MAX_NUM_ATTEMPTS_ALLOWED>>
+      num_targets_solved_by_attempts_used;
+  if (best_guess.cost < INFINITE_COST) {
+    num_targets_solved_by_attempts_used = count_targets_solved_by_attempts_used(
+        bank, cache, num_attempts_allowed, num_attempts_used, remaining_words,
+        best_guess.guess, get_guess_cost, pruning_policy);
+  }
+  {
+    std::unique_lock lock(cache.mutex);
+    result_cache[cache_key] = {
+        .guess = get_root_word(bank, best_guess.guess),
+        .cost = best_guess.cost - depth_cost,
+        .num_targets_solved_by_attempts_used =
+            num_targets_solved_by_attempts_used,
+    };
+  }
+  span.set_result(get_word_letters(bank, best_guess.guess), best_guess.cost);
   return best_guess;
 }
 
+/*
+  Costs under `get_guess_cost`, without any search, the strategy cached by the
+  `find_best_guess` call with the same arguments but `found_under_guess_cost`
+  as its cost model. Returns `std::nullopt` if there is no such result, or if
+  its targets solved by each attempt are unknown.
+*/
+template <typename bank_type>
+std::optional<candidate_info> rescore_cached_strategy(
+    const bank_type& bank, bot_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, word_list_view remaining_words,
+    guess_cost_function found_under_guess_cost,
+    guess_cost_function get_guess_cost,
+    candidate_pruning_policy pruning_policy =
+        default_candidate_pruning_policy) {
+  double depth_cost;
+  find_best_guess_cache_key cache_key = make_find_best_guess_cache_key(
+      depth_cost, bank, num_attempts_used, remaining_words,
+      found_under_guess_cost, pruning_policy);
+  std::shared_lock lock(cache.mutex);
+  const cached_best_guess* cached = find_cached_best_guess(
+      cache, num_attempts_allowed - num_attempts_used, cache_key);
+  if (cached == nullptr ||
+      !cached->num_targets_solved_by_attempts_used.has_value()) {
+    return std::nullopt;
+  }
+  candidate_info strategy = {
+      .guess = find_word_by_root_word(bank, cached->guess),
+      .cost = 0.0,
+  };
+  for (int k = 0; k < MAX_NUM_ATTEMPTS_ALLOWED; k++) {
+    int num_targets_solved =
+        cached->num_targets_solved_by_attempts_used.value()[k];
+    if (num_targets_solved > 0) {
+      strategy.cost +=
+          num_targets_solved * get_guess_cost(num_attempts_used + k + 1);
+    }
+  }
+  return strategy;
+}
+
 struct strategy {
   int guess;
   bool can_guess_be_target;
@@ -688,9 +2478,10 @@ struct strategy {
   std::unordered_map<int, std::optional<strategy>> follow_ups_by_verdict;
 };
 
+template <typename bank_type>
 std::optional<strategy> find_best_strategy(
-    const word_bank& bank, bot_cache& cache, int num_attempts_allowed,
-    int num_attempts_used, const word_list& remaining_words,
+    const bank_type& bank, bot_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, word_list_view remaining_words,
     std::optional<int> forced_first_guess = std::nullopt,
     guess_cost_function get_guess_cost = get_flat_guess_cost,
     candidate_pruning_policy pruning_policy =
@@ -724,7 +2515,7 @@ std::optional<strategy> find_best_strategy(
   auto record_best_follow_up_for_verdict_group =
       [&bank, &cache, num_attempts_allowed, num_attempts_used, get_guess_cost,
        &best_strategy, &num_targets_seen,
-       pruning_policy](int verdict, const word_list& verdict_group,
+       pruning_policy](int verdict, word_list_view verdict_group,
                        candidate_info best_follow_up) -> void {
     num_targets_seen += verdict_group.num_targets;
     strategy follow_up =
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "bot.hh"
+
+namespace wordy_witch {
+
+constexpr char INCLUDE_TARGETS_ONLY[] = "targets";
+constexpr char INCLUDE_COMMON_WORDS_ONLY[] = "common";
+constexpr char INCLUDE_ALL_WORDS[] = "all";
+
+void read_words(std::vector<std::string>& out_words,
+                std::filesystem::path word_list_path) {
+  std::ifstream file(word_list_path);
+  for (std::string word; file >> word;) {
+    out_words.push_back(word);
+  }
+}
+
+/*
+  Reads the `--flag value` pairs of a command line into `flags`, which holds
+  the flags with a default value; `optional_flags` lists those without one.
+  Returns an error message for any other flag, or a flag without a value.
+*/
+std::optional<std::string> parse_flags(
+    std::map<std::string, std::string>& flags,
+    const std::set<std::string>& optional_flags, int argc, char** argv) {
+  for (int i = 1; i < argc; i += 2) {
+    std::string flag = argv[i];
+    if (flags.count(flag) == 0 && optional_flags.count(flag) == 0) {
+      return "Unknown flag " + flag;
+    }
+    if (i + 1 == argc) {
+      return "No value for flag " + flag;
+    }
+    flags[flag] = argv[i + 1];
+  }
+  return std::nullopt;
+}
+
+std::string to_upper(std::string word) {
+  for (char& letter : word) {
+    letter = std::toupper(letter);
+  }
+  return word;
+}
+
+/*
+  Reads the words of the bank stored under `dict_path` (as in
+  `bank/co_wordle`), targets first, with `guesses_inclusion` being one of
+  `INCLUDE_TARGETS_ONLY`, `INCLUDE_COMMON_WORDS_ONLY` and `INCLUDE_ALL_WORDS`;
+  returns the number of targets
+*/
+int read_bank_words(std::vector<std::string>& out_words,
+                    std::filesystem::path dict_path,
+                    const std::string& guesses_inclusion) {
+  read_words(out_words, dict_path / "targets.txt");
+  int num_targets = out_words.size();
+  if (guesses_inclusion != INCLUDE_TARGETS_ONLY) {
+    read_words(out_words, dict_path / "common_guesses.txt");
+    if (guesses_inclusion == INCLUDE_ALL_WORDS) {
+      read_words(out_words, dict_path / "uncommon_guesses.txt");
+    }
+  }
+  return num_targets;
+}
+
+/*
+  Loads the bank stored under `dict_path` (see `read_bank_words`); returns
+  false if the bank has no targets or its words do not fit `bank_type`
+*/
+template <typename bank_type>
+bool read_bank(bank_type& out_bank, std::filesystem::path dict_path,
+               const std::string& guesses_inclusion) {
+  std::vector<std::string> words;
+  int num_targets = read_bank_words(words, dict_path, guesses_inclusion);
+  if (num_targets == 0) {
+    return false;
+  }
+  return load_bank(out_bank, words, num_targets);
+}
+
+/*
+  Loads one bank holding every word of the banks stored under `dict_paths`,
+  to be shared by views of them (see `read_bank_view`); a word is a target if
+  it is one in any of the banks
+*/
+template <typename bank_type>
+bool read_union_bank(bank_type& out_bank,
+                     const std::vector<std::filesystem::path>& dict_paths,
+                     const std::string& guesses_inclusion) {
+  std::vector<std::vector<std::string>> words_by_bank(dict_paths.size());
+  std::vector<int> num_targets_by_bank(dict_paths.size());
+  for (int b = 0; b < dict_paths.size(); b++) {
+    num_targets_by_bank[b] =
+        read_bank_words(words_by_bank[b], dict_paths[b], guesses_inclusion);
+  }
+  std::vector<std::string> words;
+  std::unordered_set<std::string> words_seen;
+  int num_targets = 0;
+  for (bool is_target : {true, false}) {
+    for (int b = 0; b < dict_paths.size(); b++) {
+      for (int i = 0; i < words_by_bank[b].size(); i++) {
+        std::string word = to_upper(words_by_bank[b][i]);
+        if ((i < num_targets_by_bank[b]) == is_target &&
+            words_seen.insert(word).second) {
+          words.push_back(word);
+        }
+      }
+    }
+    if (is_target) {
+      num_targets = words.size();
+    }
+  }
+  if (num_targets == 0) {
+    return false;
+  }
+  return load_bank(out_bank, words, num_targets);
+}
+
+/*
+  Makes `out_view` the bank stored under `dict_path` (see `read_bank`), read
+  off its root bank, which must hold all of its words
+*/
+template <typename root_bank_type>
+bool read_bank_view(basic_bank_view<root_bank_type>& out_view,
+                    std::filesystem::path dict_path,
+                    const std::string& guesses_inclusion) {
+  std::vector<std::string> words;
+  int num_targets = read_bank_words(words, dict_path, guesses_inclusion);
+  if (num_targets == 0) {
+    return false;
+  }
+  return load_bank_view(out_view, words, num_targets);
+}
+
+/*
+  Costs the same as `get_flat_guess_cost`, except that needing a 4th attempt
+  or more is so costly that it is only ever chosen when unavoidable
+*/
+double get_guess_cost_with_penalty_from_attempt_4(int num_attempts_used) {
+  return num_attempts_used + (num_attempts_used >= 4) * 1E6;
+}
+
+/*
+  Cost models are referred to by name by the command line tools; each one is a
+  plain function so that cached results for different models never mix
+*/
+std::optional<guess_cost_function> find_guess_cost_function(
+    const std::string& name) {
+  if (name == "flat") {
+    return get_flat_guess_cost;
+  }
+  if (name == "penalty") {
+    return get_guess_cost_with_penalty_from_attempt_4;
+  }
+  return std::nullopt;
+}
+
+/*
+  Replays a board state given as alternating guesses and verdict tiles (e.g.
+  `{"LEAST", "-^--#", "CRANE"}`) from the full bank; a trailing guess without
+  a verdict is left for the caller. Returns an error message if some word or
+  verdict is not recognized.
+*/
+template <typename bank_type>
+std::optional<std::string> apply_board_state(
+    word_list& out_remaining_words, const bank_type& bank,
+    const std::vector<std::string>& state) {
+  list_all_words(out_remaining_words, bank);
+  for (int i = 0; i < state.size(); i++) {
+    if (i % 2 == 0) {
+      if (!find_word(bank, to_upper(state[i])).has_value()) {
+        return "unknown word " + state[i];
+      }
+      continue;
+    }
+    int guess = find_word(bank, to_upper(state[i - 1])).value();
+    std::optional<int> verdict =
+        parse_verdict<bank_type::WORD_SIZE>(state[i]);
+    if (!verdict.has_value()) {
+      return "invalid verdict " + state[i];
+    }
+    apply_verdict(out_remaining_words, bank, guess, verdict.value());
+    if (out_remaining_words.num_targets == 0) {
+      return "no target is left after " + state[i - 1] + " " + state[i];
+    }
+  }
+  return std::nullopt;
+}
+
+/*
+  The opening book of a bank lives next to its word lists, and holds
+  precomputed `find_best_guess` results for its most expensive states (the
+  root and the replies to common openers), one per line
+*/
+constexpr char OPENING_BOOK_FILE_NAME[] = "opening_book.txt";
+
+struct opening_book_entry {
+  uint64_t bank_hash;
+  /* As accepted by `find_guess_cost_function` */
+  std::string cost_model;
+  candidate_pruning_policy pruning_policy;
+  int num_attempts_allowed;
+  /* As accepted by `apply_board_state`, ending with a verdict if not empty */
+  std::vector<std::string> state;
+  std::string best_guess;
+  double cost;
+};
+
+/* Everything but the result, separated by tabs */
+std::string format_opening_book_entry_key(const opening_book_entry& entry) {
+  std::ostringstream line;
+  line << std::setprecision(17);
+  line << entry.bank_hash << "\t" << entry.cost_model << "\t"
+       << entry.pruning_policy.max_entropy_place_to_consider << "\t";
+  if (entry.pruning_policy.max_entropy_place_to_consider_for_initial_attempt
+          .has_value()) {
+    line << entry.pruning_policy
+                .max_entropy_place_to_consider_for_initial_attempt.value();
+  } else {
+    line << "-";
+  }
+  line << "\t" << entry.pruning_policy.max_entropy_difference_to_consider
+       << "\t"
+       << entry.pruning_policy
+              .max_num_attempts_used_to_prune_by_two_attempt_entropy
+       << "\t" << entry.num_attempts_allowed << "\t";
+  if (entry.state.empty()) {
+    line << "-";
+  }
+  for (int i = 0; i < entry.state.size(); i++) {
+    line << (i > 0 ? "," : "") << entry.state[i];
+  }
+  return line.str();
+}
+
+std::string format_opening_book_entry(const opening_book_entry& entry) {
+  std::ostringstream line;
+  line << std::setprecision(17);
+  line << format_opening_book_entry_key(entry) << "\t" << entry.best_guess
+       << "\t" << entry.cost;
+  return line.str();
+}
+
+std::optional<opening_book_entry> parse_opening_book_entry(
+    const std::string& line) {
+  std::vector<std::string> fields;
+  std::istringstream line_stream(line);
+  for (std::string field; std::getline(line_stream, field, '\t');) {
+    fields.push_back(field);
+  }
+  if (fields.size() != 10) {
+    return std::nullopt;
+  }
+  try {
+    opening_book_entry entry = {
+        .bank_hash = std::stoull(fields[0]),
+        .cost_model = fields[1],
+        .pruning_policy =
+            {
+                .max_entropy_place_to_consider = std::stoi(fields[2]),
+                .max_entropy_difference_to_consider = std::stod(fields[4]),
+                .max_num_attempts_used_to_prune_by_two_attempt_entropy =
+                    std::stoi(fields[5]),
+            },
+        .num_attempts_allowed = std::stoi(fields[6]),
+        .best_guess = fields[8],
+        .cost = std::stod(fields[9]),
+    };
+    if (fields[3] != "-") {
+      entry.pruning_policy.max_entropy_place_to_consider_for_initial_attempt =
+          std::stoi(fields[3]);
+    }
+    if (fields[7] != "-") {
+      std::istringstream state(fields[7]);
+      for (std::string word; std::getline(state, word, ',');) {
+        entry.state.push_back(word);
+      }
+    }
+    return entry;
+  } catch (const std::exception&) {
+    return std::nullopt;
+  }
+}
+
+void read_opening_book_entries(std::vector<opening_book_entry>& out_entries,
+                               std::filesystem::path opening_book_path) {
+  std::ifstream file(opening_book_path);
+  for (std::string line; std::getline(file, line);) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::optional<opening_book_entry> entry = parse_opening_book_entry(line);
+    if (entry.has_value()) {
+      out_entries.push_back(entry.value());
+    }
+  }
+}
+
+/* Writes `entries` as a whole opening book, replacing any file there */
+void write_opening_book_entries(
+    std::filesystem::path opening_book_path,
+    const std::vector<opening_book_entry>& entries) {
+  std::ofstream file(opening_book_path);
+  file << "# bank hash, cost model, places, initial places, entropy "
+          "difference, two-attempt entropy attempts, attempts allowed, "
+          "state, best guess, cost"
+       << std::endl;
+  for (const opening_book_entry& entry : entries) {
+    file << format_opening_book_entry(entry) << std::endl;
+  }
+}
+
+/*
+  Preloads into `cache` the entries built for `bank`, so that
+  `find_best_guess` answers them without searching; returns the number of
+  entries preloaded
+*/
+template <typename bank_type>
+int preload_opening_book_entries(
+    const bank_type& bank, bot_cache& cache,
+    const std::vector<opening_book_entry>& entries) {
+  static thread_local std::unique_ptr<word_list> preallocated_remaining_words =
+      std::make_unique_for_overwrite<word_list>();
+  word_list& remaining_words = *preallocated_remaining_words;
+  int num_entries_preloaded = 0;
+  for (const opening_book_entry& entry : entries) {
+    std::optional<guess_cost_function> get_guess_cost =
+        find_guess_cost_function(entry.cost_model);
+    std::optional<int> best_guess = find_word(bank, entry.best_guess);
+    int num_attempts_used = entry.state.size() / 2;
+    if (entry.bank_hash != bank.hash || !get_guess_cost.has_value() ||
+        !best_guess.has_value() || entry.state.size() % 2 == 1 ||
+        num_attempts_used >= entry.num_attempts_allowed ||
+        entry.num_attempts_allowed > MAX_NUM_ATTEMPTS_ALLOWED ||
+        apply_board_state(remaining_words, bank, entry.state).has_value()) {
+      continue;
+    }
+    preload_best_guess(bank, cache, entry.num_attempts_allowed,
+                       num_attempts_used, remaining_words,
+                       get_guess_cost.value(), entry.pruning_policy,
+                       candidate_info{
+                           .guess = best_guess.value(),
+                           .cost = entry.cost,
+                       });
+    num_entries_preloaded++;
+  }
+  return num_entries_preloaded;
+}
+
+/*
+  Preloads the entries of the opening book at `opening_book_path` (see
+  `preload_opening_book_entries`); a missing book counts as an empty one
+*/
+template <typename bank_type>
+int read_opening_book(const bank_type& bank, bot_cache& cache,
+                      std::filesystem::path opening_book_path) {
+  std::vector<opening_book_entry> entries;
+  read_opening_book_entries(entries, opening_book_path);
+  return preload_opening_book_entries(bank, cache, entries);
+}
+
+}  // namespace wordy_witch
@@ -7,59 +7,30 @@
 #include <vector>
 
 #include "../bot.hh"
+#include "../cli.hh"
 #include "../log.hh"
 
 int main() {
-  auto read_bank = [](wordy_witch::word_bank& out_bank,
-                      std::filesystem::path dict_path,
-                      const std::string& guesses_inclusion) -> void {
-    constexpr char INCLUDE_TARGETS_ONLY[] = "targets";
-    constexpr char INCLUDE_COMMON_WORDS_ONLY[] = "common";
-    constexpr char INCLUDE_ALL_WORDS[] = "all";
-
-    auto read_and_append_words =
-        [](std::vector<std::string>& words,
-           std::filesystem::path word_list_path) -> void {
-      std::ifstream file(word_list_path);
-      for (std::string word; file >> word;) {
-        words.push_back(word);
-      }
-    };
-
-    std::vector<std::string> words;
-    read_and_append_words(words, dict_path / "targets.txt");
-    int num_targets = words.size();
-    if (guesses_inclusion != INCLUDE_TARGETS_ONLY) {
-      read_and_append_words(words, dict_path / "common_guesses.txt");
-      if (guesses_inclusion == INCLUDE_ALL_WORDS) {
-        read_and_append_words(words, dict_path / "uncommon_guesses.txt");
-      }
-    }
-    wordy_witch::load_bank(out_bank, words, num_targets);
-  };
   static wordy_witch::word_bank bank;
-  read_bank(bank,
-            "../../bank/co_wordle_unlimited",  //
-            // "./output/temp_bank_c_ghaut_tapes_pryer",  //
-            "common");
+  wordy_witch::read_bank(bank,
+                         "../../bank/co_wordle_unlimited",  //
+                         // "./output/temp_bank_c_ghaut_tapes_pryer",  //
+                         wordy_witch::INCLUDE_COMMON_WORDS_ONLY);
 
   std::vector<std::string> state = {
       "LEAST",
   };
   wordy_witch::guess_cost_function get_guess_cost;
   get_guess_cost = wordy_witch::get_flat_guess_cost;
-  get_guess_cost = [](int num_attempts_used) -> double {
-    return num_attempts_used + (num_attempts_used >= 4) * 1E6;
-  };
+  // get_guess_cost = wordy_witch::get_guess_cost_with_penalty_from_attempt_4;
+  /* The settings of the shipped opening book, whose entries answer LEAST */
   wordy_witch::candidate_pruning_policy pruning_policy = {
-      .max_entropy_place_to_consider = 64,
+      .max_entropy_place_to_consider = 32,
   };
   WORDY_WITCH_TRACE("Done bank loading");
 
   static wordy_witch::word_list remaining_words;
-  remaining_words.num_words = bank.num_words;
-  remaining_words.num_targets = bank.num_targets;
-  std::iota(remaining_words.words, std::end(remaining_words.words), 0);
+  wordy_witch::list_all_words(remaining_words, bank);
 
   auto display_initial_message_and_parse_state =
       [](wordy_witch::word_list& remaining_words,
@@ -74,16 +45,8 @@ int main() {
       std::cout << state[i - 1] << std::endl;
       static wordy_witch::verdict_groups groups;
       wordy_witch::group_remaining_words(groups, bank, remaining_words, guess);
-      auto parse_verdict = [](const std::string& tiles) -> std::optional<int> {
-        for (int verdict = 0; verdict < wordy_witch::NUM_VERDICTS; verdict++) {
-          if (wordy_witch::format_verdict(verdict) == tiles) {
-            return verdict;
-          }
-        }
-        return std::nullopt;
-      };
-      int verdict = parse_verdict(state[i]).value();
-      remaining_words = groups[verdict];
+      int verdict = wordy_witch::parse_verdict(state[i]).value();
+      wordy_witch::copy_word_list(remaining_words, groups[verdict]);
       std::cout << state[i] << std::endl;
     }
     if (state.size() % 2 == 1) {
@@ -94,6 +57,10 @@ int main() {
   display_initial_message_and_parse_state(remaining_words, bank, state);
 
   static wordy_witch::bot_cache bot_cache = {};
+  wordy_witch::read_opening_book(
+      bank, bot_cache,
+      std::filesystem::path("../../bank/co_wordle_unlimited") /
+          wordy_witch::OPENING_BOOK_FILE_NAME);
 
   auto find_and_display_best_guess =
       [](const wordy_witch::word_bank& bank, wordy_witch::bot_cache& cache,
@@ -177,6 +144,16 @@ int main() {
               << ", Cost: " << best_guess.cost
               << ", EC: " << best_guess.cost / remaining_words.num_targets
               << ")" << std::endl;
+    std::optional<wordy_witch::candidate_info> flat_strategy =
+        wordy_witch::rescore_cached_strategy(
+            bank, cache, wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED,
+            num_attempts_used, remaining_words, get_guess_cost,
+            wordy_witch::get_flat_guess_cost, pruning_policy);
+    if (flat_strategy.has_value()) {
+      std::cout << "(EA of its strategy: "
+                << flat_strategy.value().cost / remaining_words.num_targets
+                << ")" << std::endl;
+    }
   };
 
   auto find_and_display_best_guess_by_verdict =
@@ -219,7 +196,7 @@ int main() {
     int guess = wordy_witch::find_word(bank, prev_guess).value();
     auto display_best_guess_for_verdict_group =
         [&bank, &prev_guess](int verdict,
-                             const wordy_witch::word_list& verdict_group,
+                             wordy_witch::word_list_view verdict_group,
                              wordy_witch::candidate_info best_guess) -> void {
       WORDY_WITCH_TRACE("Analyzed candidate", verdict, best_guess.guess,
                         best_guess.cost);
@@ -295,7 +272,8 @@ int main() {
                          strategy.num_remaining_targets
                   << ")";
       }
-      for (int verdict = wordy_witch::NUM_VERDICTS; verdict >= 0; verdict--) {
+      for (int verdict = wordy_witch::word_bank::NUM_VERDICTS; verdict >= 0;
+           verdict--) {
         if (strategy.follow_ups_by_verdict.count(verdict) == 0) {
           continue;
         }
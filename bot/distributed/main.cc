@@ -0,0 +1,566 @@
+/*
+  Splits one deep search across worker processes, on one or more hosts, that
+  share a directory.
+
+  The coordinator first splits the candidates of the state into units of
+  `--unit-size` guesses, which workers evaluate, and keeps the best one
+  exactly as `find_best_guess` would. It then makes a unit of every verdict
+  group of that guess (or of `--opener`): workers build the best strategy for
+  the group and send back the `find_best_guess` result of every node of it.
+  The coordinator preloads those results, builds the whole strategy out of
+  them, and writes them in the opening book format to `book.txt`, so that
+  they can be merged into an opening book.
+
+  Everything goes through files under `--dir`:
+    job.txt      the job flags, one `--flag value` per line
+    units/U      unit U waiting for a worker; a worker claims it by renaming
+                 it to `claimed/U`, which only one worker can do
+    results/U    the result of unit U, renamed there once complete
+    done         tells the workers that the job is over
+  A unit claimed for longer than `--lease` seconds without a result is handed
+  out again; results do not depend on which worker computed them.
+
+  Running a job with 3 local workers:
+    ./main --role coordinator --dir /tmp/job --bank co_wordle_unlimited &
+    for i in 1 2 3; do ./main --role worker --dir /tmp/job & done; wait
+
+  Flags (each followed by a value):
+    --role         `coordinator` or `worker`
+    --dir          directory shared by the coordinator and the workers
+    --bank-root    directory holding the banks (default `../../bank`)
+    --threads      threads of a worker searching each unit (default: all
+                   cores)
+  Job flags, given to the coordinator only:
+    --bank         bank to search (default `co_wordle`)
+    --guesses      `targets`, `common` (default) or `all`
+    --cost         `flat` (default) or `penalty`
+    --places       `max_entropy_place_to_consider` (default 32)
+    --initial-places
+                   `max_entropy_place_to_consider_for_initial_attempt`
+    --attempts     number of attempts allowed (default 6)
+    --state        comma-separated guesses and verdicts, e.g. `LEAST,-^--#`
+    --opener       guess to build the strategy with, skipping the candidates
+    --unit-size    candidates per unit (default 4)
+    --lease        seconds before a claimed unit is handed out again (default
+                   0, never)
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../bot.hh"
+#include "../cli.hh"
+#include "../log.hh"
+#include "../work_stealing.hh"
+
+constexpr char UNIT_KIND_CANDIDATES[] = "candidates";
+constexpr char UNIT_KIND_STATE[] = "state";
+constexpr auto POLLING_INTERVAL = std::chrono::milliseconds(100);
+
+std::vector<std::string> split(const std::string& text, char delimiter) {
+  std::vector<std::string> parts;
+  std::istringstream stream(text);
+  for (std::string part; std::getline(stream, part, delimiter);) {
+    parts.push_back(part);
+  }
+  return parts;
+}
+
+std::string join_state(const std::vector<std::string>& state) {
+  std::string text;
+  for (int i = 0; i < state.size(); i++) {
+    text += (i > 0 ? "," : "") + state[i];
+  }
+  return text.empty() ? "-" : text;
+}
+
+std::vector<std::string> parse_state(const std::string& text) {
+  return text == "-" ? std::vector<std::string>() : split(text, ',');
+}
+
+std::vector<std::string> read_lines(std::filesystem::path path) {
+  std::vector<std::string> lines;
+  std::ifstream file(path);
+  for (std::string line; std::getline(file, line);) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+/*
+  Readers never see a partially written file, as long as no two writers use
+  the same `temporary_suffix`
+*/
+void write_file_atomically(std::filesystem::path path,
+                           const std::string& content,
+                           const std::string& temporary_suffix) {
+  std::filesystem::path temporary_path = path;
+  temporary_path += temporary_suffix;
+  {
+    std::ofstream file(temporary_path);
+    file << content;
+  }
+  std::filesystem::rename(temporary_path, path);
+}
+
+std::vector<std::string> list_file_names(std::filesystem::path dir_path) {
+  std::vector<std::string> names;
+  std::error_code error;
+  for (const std::filesystem::directory_entry& entry :
+       std::filesystem::directory_iterator(dir_path, error)) {
+    names.push_back(entry.path().filename().string());
+  }
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+std::string format_unit_name(const std::string& kind, int index) {
+  std::ostringstream name;
+  name << kind << "-" << std::setw(5) << std::setfill('0') << index;
+  return name.str();
+}
+
+struct job {
+  std::unique_ptr<wordy_witch::word_bank> bank;
+  std::string cost_model;
+  wordy_witch::guess_cost_function get_guess_cost;
+  wordy_witch::candidate_pruning_policy pruning_policy;
+  int num_attempts_allowed;
+  std::vector<std::string> state;
+};
+
+/* Returns an error message if the job flags are not valid */
+std::optional<std::string> load_job(
+    job& out_job, std::map<std::string, std::string>& flags) {
+  out_job.bank = std::make_unique_for_overwrite<wordy_witch::word_bank>();
+  if (!wordy_witch::read_bank(
+          *out_job.bank,
+          std::filesystem::path(flags["--bank-root"]) / flags["--bank"],
+          flags["--guesses"])) {
+    return "cannot load bank " + flags["--bank"];
+  }
+  out_job.cost_model = flags["--cost"];
+  std::optional<wordy_witch::guess_cost_function> get_guess_cost =
+      wordy_witch::find_guess_cost_function(out_job.cost_model);
+  if (!get_guess_cost.has_value()) {
+    return "unknown cost " + out_job.cost_model;
+  }
+  out_job.get_guess_cost = get_guess_cost.value();
+  out_job.pruning_policy = {
+      .max_entropy_place_to_consider = std::stoi(flags["--places"]),
+  };
+  if (!flags["--initial-places"].empty()) {
+    out_job.pruning_policy.max_entropy_place_to_consider_for_initial_attempt =
+        std::stoi(flags["--initial-places"]);
+  }
+  out_job.num_attempts_allowed = std::stoi(flags["--attempts"]);
+  if (out_job.num_attempts_allowed > wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED) {
+    return "too many attempts";
+  }
+  out_job.state = split(flags["--state"], ',');
+  return std::nullopt;
+}
+
+/*
+  The opening book entries of every node of `node_strategy`, which was built
+  for `state`; nodes whose best guess `find_best_guess` never caches are left
+  out
+*/
+void list_strategy_entries(std::vector<wordy_witch::opening_book_entry>& out,
+                           const job& job,
+                           const wordy_witch::strategy& node_strategy,
+                           const std::vector<std::string>& state) {
+  if (node_strategy.num_remaining_targets > 2) {
+    out.push_back({
+        .bank_hash = job.bank->hash,
+        .cost_model = job.cost_model,
+        .pruning_policy = job.pruning_policy,
+        .num_attempts_allowed = job.num_attempts_allowed,
+        .state = state,
+        .best_guess = job.bank->words[node_strategy.guess],
+        .cost = node_strategy.cost,
+    });
+  }
+  for (int verdict = 0; verdict < wordy_witch::word_bank::NUM_VERDICTS;
+       verdict++) {
+    auto it = node_strategy.follow_ups_by_verdict.find(verdict);
+    if (it == node_strategy.follow_ups_by_verdict.end() ||
+        !it->second.has_value()) {
+      continue;
+    }
+    std::vector<std::string> follow_up_state = state;
+    follow_up_state.push_back(job.bank->words[node_strategy.guess]);
+    follow_up_state.push_back(wordy_witch::format_verdict(verdict));
+    list_strategy_entries(out, job, it->second.value(), follow_up_state);
+  }
+}
+
+std::string compute_unit_result(const job& job, wordy_witch::bot_cache& cache,
+                                 const std::vector<std::string>& unit) {
+  static wordy_witch::word_list remaining_words;
+  std::vector<std::string> state = parse_state(unit.at(1));
+  wordy_witch::apply_board_state(remaining_words, *job.bank, state);
+  int num_attempts_used = state.size() / 2;
+
+  std::ostringstream result;
+  result << std::setprecision(17);
+  if (unit.at(0) == UNIT_KIND_CANDIDATES) {
+    for (int i = 2; i < unit.size(); i++) {
+      int guess = wordy_witch::find_word(*job.bank, unit[i]).value();
+      double cost = wordy_witch::evaluate_guess(
+          *job.bank, cache, job.num_attempts_allowed, num_attempts_used + 1,
+          remaining_words, guess, {}, job.get_guess_cost, job.pruning_policy);
+      result << unit[i] << "\t" << cost << std::endl;
+    }
+    return result.str();
+  }
+
+  std::vector<wordy_witch::opening_book_entry> entries;
+  std::optional<wordy_witch::strategy> best_strategy =
+      wordy_witch::find_best_strategy(
+          *job.bank, cache, job.num_attempts_allowed, num_attempts_used,
+          remaining_words, std::nullopt, job.get_guess_cost,
+          job.pruning_policy);
+  if (best_strategy.has_value()) {
+    list_strategy_entries(entries, job, best_strategy.value(), state);
+  } else {
+    /* No strategy wins every game; the group is recorded as lost. */
+    wordy_witch::candidate_info best_guess = wordy_witch::find_best_guess(
+        *job.bank, cache, job.num_attempts_allowed, num_attempts_used,
+        remaining_words, {}, job.get_guess_cost, job.pruning_policy);
+    entries.push_back({
+        .bank_hash = job.bank->hash,
+        .cost_model = job.cost_model,
+        .pruning_policy = job.pruning_policy,
+        .num_attempts_allowed = job.num_attempts_allowed,
+        .state = state,
+        .best_guess = job.bank->words[best_guess.guess],
+        .cost = best_guess.cost,
+    });
+  }
+  for (const wordy_witch::opening_book_entry& entry : entries) {
+    result << wordy_witch::format_opening_book_entry(entry) << std::endl;
+  }
+  return result.str();
+}
+
+int run_worker(std::map<std::string, std::string>& flags) {
+  std::filesystem::path dir_path = flags["--dir"];
+  std::string worker_id = std::to_string(std::random_device()());
+  while (!std::filesystem::exists(dir_path / "job.txt")) {
+    std::this_thread::sleep_for(POLLING_INTERVAL);
+  }
+  for (const std::string& line : read_lines(dir_path / "job.txt")) {
+    std::vector<std::string> flag = split(line, ' ');
+    flags[flag.at(0)] = flag.size() > 1 ? flag[1] : "";
+  }
+  static job job;
+  if (std::optional<std::string> error = load_job(job, flags);
+      error.has_value()) {
+    std::cerr << "Cannot run the job: " << error.value() << std::endl;
+    return 1;
+  }
+  WORDY_WITCH_TRACE("Done job loading", worker_id);
+
+  static wordy_witch::bot_cache cache;
+  wordy_witch::work_stealing_pool pool(std::stoi(flags["--threads"]));
+  while (!std::filesystem::exists(dir_path / "done")) {
+    bool has_claimed_unit = false;
+    for (const std::string& unit_name : list_file_names(dir_path / "units")) {
+      std::filesystem::path claimed_unit_path =
+          dir_path / "claimed" / unit_name;
+      std::error_code error;
+      std::filesystem::rename(dir_path / "units" / unit_name,
+                              claimed_unit_path, error);
+      if (error) {
+        /* Another worker claimed it first. */
+        continue;
+      }
+      std::filesystem::last_write_time(
+          claimed_unit_path, std::filesystem::file_time_type::clock::now(),
+          error);
+      has_claimed_unit = true;
+      WORDY_WITCH_TRACE("Claimed unit", worker_id, unit_name);
+      std::string result;
+      wordy_witch::run_in_work_stealing_pool(pool, [&]() -> void {
+        result = compute_unit_result(job, cache, read_lines(claimed_unit_path));
+      });
+      write_file_atomically(dir_path / "results" / unit_name, result,
+                            ".tmp." + worker_id);
+      WORDY_WITCH_TRACE("Done unit", worker_id, unit_name);
+      break;
+    }
+    if (!has_claimed_unit) {
+      std::this_thread::sleep_for(POLLING_INTERVAL);
+    }
+  }
+  return 0;
+}
+
+/*
+  Hands out `units` (named by `format_unit_name` with `kind`) and returns
+  their results, in the same order
+*/
+std::vector<std::vector<std::string>> distribute_units(
+    std::filesystem::path dir_path, const std::string& kind,
+    const std::vector<std::vector<std::string>>& units, int lease_seconds) {
+  std::vector<std::string> unit_names;
+  for (int i = 0; i < units.size(); i++) {
+    unit_names.push_back(format_unit_name(kind, i));
+    std::string content;
+    for (const std::string& line : units[i]) {
+      content += line + "\n";
+    }
+    write_file_atomically(dir_path / "units" / unit_names[i], content, ".tmp");
+  }
+
+  for (int num_results = 0; num_results < units.size();) {
+    std::this_thread::sleep_for(POLLING_INTERVAL);
+    num_results = 0;
+    for (const std::string& unit_name : unit_names) {
+      num_results += std::filesystem::exists(dir_path / "results" / unit_name);
+    }
+    if (lease_seconds <= 0) {
+      continue;
+    }
+    auto lease_start_time = std::filesystem::file_time_type::clock::now() -
+                            std::chrono::seconds(lease_seconds);
+    for (const std::string& unit_name : unit_names) {
+      std::filesystem::path claimed_unit_path =
+          dir_path / "claimed" / unit_name;
+      std::error_code error;
+      if (std::filesystem::exists(dir_path / "results" / unit_name) ||
+          std::filesystem::last_write_time(claimed_unit_path, error) >
+              lease_start_time ||
+          error) {
+        continue;
+      }
+      WORDY_WITCH_TRACE("Handing out unit again", unit_name);
+      std::filesystem::rename(claimed_unit_path,
+                              dir_path / "units" / unit_name, error);
+    }
+  }
+
+  std::vector<std::vector<std::string>> results;
+  for (const std::string& unit_name : unit_names) {
+    results.push_back(read_lines(dir_path / "results" / unit_name));
+  }
+  return results;
+}
+
+int run_coordinator(std::map<std::string, std::string>& flags) {
+  std::filesystem::path dir_path = flags["--dir"];
+  if (std::filesystem::exists(dir_path / "job.txt")) {
+    std::cerr << dir_path << " already holds a job" << std::endl;
+    return 1;
+  }
+  static job job;
+  if (std::optional<std::string> error = load_job(job, flags);
+      error.has_value()) {
+    std::cerr << "Cannot run the job: " << error.value() << std::endl;
+    return 1;
+  }
+  const wordy_witch::word_bank& bank = *job.bank;
+  static wordy_witch::word_list remaining_words;
+  if (std::optional<std::string> error =
+          wordy_witch::apply_board_state(remaining_words, bank, job.state);
+      error.has_value() || job.state.size() % 2 == 1) {
+    std::cerr << "Invalid state: " << error.value_or("missing verdict")
+              << std::endl;
+    return 1;
+  }
+  int num_attempts_used = job.state.size() / 2;
+  if (remaining_words.num_targets <= 2 ||
+      num_attempts_used >= job.num_attempts_allowed - 1) {
+    std::cerr << "Nothing worth distributing in this state" << std::endl;
+    return 1;
+  }
+  std::optional<int> opener;
+  if (!flags["--opener"].empty()) {
+    opener =
+        wordy_witch::find_word(bank, wordy_witch::to_upper(flags["--opener"]));
+    if (!opener.has_value()) {
+      std::cerr << "Unknown opener " << flags["--opener"] << std::endl;
+      return 1;
+    }
+  }
+  int unit_size = std::max(1, std::stoi(flags["--unit-size"]));
+  int lease_seconds = std::stoi(flags["--lease"]);
+
+  for (const char* sub_dir_name : {"units", "claimed", "results"}) {
+    std::filesystem::create_directories(dir_path / sub_dir_name);
+  }
+  std::string job_content;
+  for (const char* name :
+       {"--bank", "--guesses", "--cost", "--places", "--initial-places",
+        "--attempts", "--state"}) {
+    job_content += std::string(name) + " " + flags[name] + "\n";
+  }
+  write_file_atomically(dir_path / "job.txt", job_content, ".tmp");
+
+  static wordy_witch::bot_cache cache;
+  std::vector<wordy_witch::opening_book_entry> entries;
+  std::cout << std::setprecision(10);
+  if (!opener.has_value()) {
+    static wordy_witch::word_list candidates;
+    wordy_witch::find_candidates_to_evaluate(candidates, bank,
+                                             num_attempts_used,
+                                             remaining_words,
+                                             job.pruning_policy);
+    std::vector<std::vector<std::string>> units;
+    for (int i = 0; i < candidates.num_words; i++) {
+      if (i % unit_size == 0) {
+        units.push_back({UNIT_KIND_CANDIDATES, join_state(job.state)});
+      }
+      units.back().push_back(bank.words[candidates.words[i]]);
+    }
+    WORDY_WITCH_TRACE("Handing out candidates", candidates.num_words,
+                      units.size());
+    std::vector<std::vector<std::string>> results =
+        distribute_units(dir_path, UNIT_KIND_CANDIDATES, units, lease_seconds);
+
+    /* Ties go to the earliest candidate, as in `find_best_guess`. */
+    wordy_witch::candidate_info best_guess = {
+        .guess = remaining_words.words[0],
+        .cost = wordy_witch::INFINITE_COST,
+    };
+    std::cout << "Guess\tCost" << std::endl;
+    for (const std::vector<std::string>& result : results) {
+      for (const std::string& line : result) {
+        std::vector<std::string> fields = split(line, '\t');
+        wordy_witch::candidate_info candidate = {
+            .guess = wordy_witch::find_word(bank, fields.at(0)).value(),
+            .cost = std::stod(fields.at(1)),
+        };
+        std::cout << fields[0] << "\t" << candidate.cost << std::endl;
+        if (candidate.cost < best_guess.cost) {
+          best_guess = candidate;
+        }
+      }
+    }
+    std::cout << std::endl;
+    if (best_guess.cost >= wordy_witch::INFINITE_COST) {
+      std::cout << "No guess wins every game" << std::endl;
+      write_file_atomically(dir_path / "done", "", ".tmp");
+      return 0;
+    }
+    wordy_witch::preload_best_guess(bank, cache, job.num_attempts_allowed,
+                                    num_attempts_used, remaining_words,
+                                    job.get_guess_cost, job.pruning_policy,
+                                    best_guess);
+    entries.push_back({
+        .bank_hash = bank.hash,
+        .cost_model = job.cost_model,
+        .pruning_policy = job.pruning_policy,
+        .num_attempts_allowed = job.num_attempts_allowed,
+        .state = job.state,
+        .best_guess = bank.words[best_guess.guess],
+        .cost = best_guess.cost,
+    });
+    opener = best_guess.guess;
+  }
+
+  static wordy_witch::verdict_groups groups;
+  wordy_witch::group_remaining_words(groups, bank, remaining_words,
+                                     opener.value());
+  std::vector<std::vector<std::string>> units;
+  for (int verdict = 0; verdict < wordy_witch::word_bank::NUM_VERDICTS;
+       verdict++) {
+    if (groups[verdict].num_targets == 0 ||
+        verdict == wordy_witch::word_bank::ALL_GREEN_VERDICT) {
+      continue;
+    }
+    std::vector<std::string> state = job.state;
+    state.push_back(bank.words[opener.value()]);
+    state.push_back(wordy_witch::format_verdict(verdict));
+    units.push_back({UNIT_KIND_STATE, join_state(state)});
+  }
+  WORDY_WITCH_TRACE("Handing out verdict groups", bank.words[opener.value()],
+                    units.size());
+  for (const std::vector<std::string>& result :
+       distribute_units(dir_path, UNIT_KIND_STATE, units, lease_seconds)) {
+    for (const std::string& line : result) {
+      std::optional<wordy_witch::opening_book_entry> entry =
+          wordy_witch::parse_opening_book_entry(line);
+      if (entry.has_value()) {
+        entries.push_back(entry.value());
+      }
+    }
+  }
+  write_file_atomically(dir_path / "done", "", ".tmp");
+  wordy_witch::preload_opening_book_entries(bank, cache, entries);
+  wordy_witch::write_opening_book_entries(dir_path / "book.txt", entries);
+
+  std::optional<wordy_witch::strategy> strategy =
+      wordy_witch::find_best_strategy(
+          bank, cache, job.num_attempts_allowed, num_attempts_used,
+          remaining_words, opener, job.get_guess_cost, job.pruning_policy);
+  if (!strategy.has_value()) {
+    std::cout << "No strategy starting with " << bank.words[opener.value()]
+              << " wins every game" << std::endl;
+    return 0;
+  }
+  std::cout << "Best strategy starts with " << bank.words[opener.value()]
+            << " (Cost: " << strategy.value().cost << ", mean attempts: "
+            << strategy.value().total_num_attempts_used * 1.0 /
+                   remaining_words.num_targets
+            << ", nodes searched here: "
+            << cache.stats.num_nodes_searched.load() << ")" << std::endl;
+  std::cout << "Attempts used:";
+  for (int i = 0; i < job.num_attempts_allowed; i++) {
+    std::cout << " " << strategy.value().num_targets_solved_by_attempts_used[i];
+  }
+  std::cout << std::endl;
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  std::map<std::string, std::string> flags = {
+      {"--role", ""},
+      {"--dir", ""},
+      {"--bank-root", "../../bank"},
+      {"--bank", "co_wordle"},
+      {"--guesses", wordy_witch::INCLUDE_COMMON_WORDS_ONLY},
+      {"--cost", "flat"},
+      {"--places", "32"},
+      {"--initial-places", ""},
+      {"--attempts", std::to_string(wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED)},
+      {"--state", ""},
+      {"--opener", ""},
+      {"--unit-size", "4"},
+      {"--lease", "0"},
+      {"--threads",
+       std::to_string(std::max(1U, std::thread::hardware_concurrency()))},
+  };
+  std::optional<std::string> flag_error =
+      wordy_witch::parse_flags(flags, {}, argc, argv);
+  if (flag_error.has_value()) {
+    std::cerr << flag_error.value() << std::endl;
+    return 1;
+  }
+  if (flags["--dir"].empty()) {
+    std::cerr << "Missing --dir" << std::endl;
+    return 1;
+  }
+  if (flags["--role"] == "coordinator") {
+    return run_coordinator(flags);
+  }
+  if (flags["--role"] == "worker") {
+    return run_worker(flags);
+  }
+  std::cerr << "Unknown role " << flags["--role"] << std::endl;
+  return 1;
+}
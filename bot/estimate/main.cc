@@ -0,0 +1,175 @@
+/*
+  Checks Monte Carlo estimates against the exact solver: for every candidate
+  `find_best_guess` would evaluate in a board state, reports its estimated
+  cost (see `estimate_guess_cost`) next to its exact cost, then how often the
+  exact cost falls in the confidence interval, the mean relative error, the
+  time taken by each, and the place of the exact best guess in the ranking by
+  estimates (which bounds the candidates worth evaluating after estimation).
+
+  Flags (each followed by a value):
+    --bank-root    directory holding the banks (default `../../bank`)
+    --bank         bank to analyze (default `co_wordle`)
+    --guesses      `targets`, `common` (default) or `all`
+    --state        comma-separated guesses and verdicts, as in `cli.hh`
+                   (default: the initial state)
+    --cost         `flat` (default) or `penalty`
+    --places       `max_entropy_place_to_consider` (default 32)
+    --samples      samples per estimate (default 256)
+    --seed         seed of the first estimate, incremented for each next one
+                   (default 1)
+*/
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../bot.hh"
+#include "../cli.hh"
+#include "../log.hh"
+
+int main(int argc, char** argv) {
+  std::map<std::string, std::string> flags = {
+      {"--bank-root", "../../bank"},
+      {"--bank", "co_wordle"},
+      {"--guesses", wordy_witch::INCLUDE_COMMON_WORDS_ONLY},
+      {"--state", ""},
+      {"--cost", "flat"},
+      {"--places", "32"},
+      {"--samples", "256"},
+      {"--seed", "1"},
+  };
+  std::optional<std::string> flag_error =
+      wordy_witch::parse_flags(flags, {}, argc, argv);
+  if (flag_error.has_value()) {
+    std::cerr << flag_error.value() << std::endl;
+    return 1;
+  }
+
+  static wordy_witch::word_bank bank;
+  if (!wordy_witch::read_bank(
+          bank, std::filesystem::path(flags["--bank-root"]) / flags["--bank"],
+          flags["--guesses"])) {
+    std::cerr << "Cannot load bank " << flags["--bank"] << std::endl;
+    return 1;
+  }
+  WORDY_WITCH_TRACE("Done bank loading", bank.num_words);
+  std::optional<wordy_witch::guess_cost_function> get_guess_cost =
+      wordy_witch::find_guess_cost_function(flags["--cost"]);
+  if (!get_guess_cost.has_value()) {
+    std::cerr << "Unknown cost " << flags["--cost"] << std::endl;
+    return 1;
+  }
+  wordy_witch::candidate_pruning_policy pruning_policy = {
+      .max_entropy_place_to_consider = std::stoi(flags["--places"]),
+  };
+  std::vector<std::string> state;
+  std::istringstream state_words(flags["--state"]);
+  for (std::string word; std::getline(state_words, word, ',');) {
+    state.push_back(word);
+  }
+  if (state.size() % 2 == 1) {
+    std::cerr << "The state does not end with a verdict" << std::endl;
+    return 1;
+  }
+  static wordy_witch::word_list remaining_words;
+  std::optional<std::string> error =
+      wordy_witch::apply_board_state(remaining_words, bank, state);
+  if (error.has_value()) {
+    std::cerr << error.value() << std::endl;
+    return 1;
+  }
+  int num_attempts_used = state.size() / 2;
+
+  static wordy_witch::word_list candidates;
+  wordy_witch::find_candidates_to_evaluate(candidates, bank, num_attempts_used,
+                                           remaining_words, pruning_policy);
+  static wordy_witch::bot_cache cache = {};
+  int num_samples = std::stoi(flags["--samples"]);
+  uint64_t seed = std::stoull(flags["--seed"]);
+
+  struct candidate_report {
+    int guess;
+    wordy_witch::cost_estimate estimate;
+    double exact_cost;
+  };
+  std::vector<candidate_report> reports;
+  double estimation_seconds = 0.0;
+  double evaluation_seconds = 0.0;
+  std::cout << std::setprecision(6);
+  std::cout << "Guess\tEstimate\tMargin\tExact\tError" << std::endl;
+  for (int i = 0; i < candidates.num_words; i++) {
+    int guess = candidates.words[i];
+    auto start_time = std::chrono::steady_clock::now();
+    wordy_witch::cost_estimate estimate = wordy_witch::estimate_guess_cost(
+        bank, wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED, num_attempts_used + 1,
+        remaining_words, guess, num_samples, seed + i, get_guess_cost.value());
+    auto estimated_time = std::chrono::steady_clock::now();
+    double exact_cost = wordy_witch::evaluate_guess(
+        bank, cache, wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED,
+        num_attempts_used + 1, remaining_words, guess, {},
+        get_guess_cost.value(), pruning_policy);
+    auto evaluated_time = std::chrono::steady_clock::now();
+    estimation_seconds +=
+        std::chrono::duration<double>(estimated_time - start_time).count();
+    evaluation_seconds +=
+        std::chrono::duration<double>(evaluated_time - estimated_time).count();
+    reports.push_back({
+        .guess = guess,
+        .estimate = estimate,
+        .exact_cost = exact_cost,
+    });
+    std::cout << bank.words[guess] << "\t" << estimate.cost << "\t"
+              << estimate.margin << "\t" << exact_cost << "\t"
+              << estimate.cost - exact_cost << std::endl;
+  }
+  if (reports.empty()) {
+    return 0;
+  }
+
+  int num_covered = 0;
+  int num_finite = 0;
+  double total_relative_error = 0.0;
+  int best = 0;
+  for (int i = 0; i < reports.size(); i++) {
+    const candidate_report& report = reports[i];
+    if (report.exact_cost < reports[best].exact_cost) {
+      best = i;
+    }
+    if (!std::isfinite(report.exact_cost) ||
+        !std::isfinite(report.estimate.cost)) {
+      continue;
+    }
+    num_finite++;
+    num_covered += std::abs(report.estimate.cost - report.exact_cost) <=
+                   report.estimate.margin;
+    total_relative_error +=
+        std::abs(report.estimate.cost - report.exact_cost) /
+        report.exact_cost;
+  }
+  int best_place_by_estimate = 1;
+  for (const candidate_report& report : reports) {
+    best_place_by_estimate +=
+        report.estimate.cost < reports[best].estimate.cost;
+  }
+  std::cout << std::endl;
+  std::cout << "Candidates: " << reports.size() << " (" << num_finite
+            << " with finite costs)" << std::endl;
+  std::cout << "Exact costs within the confidence interval: " << num_covered
+            << std::endl;
+  std::cout << "Mean relative error: "
+            << total_relative_error / std::max(num_finite, 1) << std::endl;
+  std::cout << "Estimation time: " << estimation_seconds
+            << "s, exact evaluation time: " << evaluation_seconds << "s"
+            << std::endl;
+  std::cout << "Exact best guess " << bank.words[reports[best].guess]
+            << " is ranked " << best_place_by_estimate << " by estimates"
+            << std::endl;
+}
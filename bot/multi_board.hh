@@ -0,0 +1,586 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "bot.hh"
+#include "work_stealing.hh"
+
+namespace wordy_witch {
+
+/*
+  In a multi-board game (Dordle, Quordle, ...), every guess is played on all
+  boards at once and each board hides its own target. A board is solved once
+  it shows the all-green verdict, and the cost of a game is the sum of
+  `get_guess_cost` over the attempts at which each board got solved.
+
+  Every board is a word list of its own, split by `group_remaining_words` as a
+  single board is. Outside hard mode, a board only lists its targets and any
+  word in the bank may be guessed. In hard mode, a board also lists the words
+  still valid on it, as a single board does, and a guess must be valid on
+  every board not solved yet.
+
+  The cost of a multi-board state is the total cost over every combination of
+  remaining targets, one per board, much like the single-board cost is the
+  total cost over every remaining target.
+*/
+struct multi_board_state {
+  /* Boards not solved yet */
+  std::vector<word_list_view> boards;
+  bool is_hard_mode = false;
+};
+
+struct word_list_hash_hasher {
+  uint64_t operator()(const word_list_hash& hash) const {
+    uint64_t combined_hash = 0;
+    for (uint64_t code : hash) {
+      combined_hash = combined_hash * 31 + code;
+    }
+    return combined_hash;
+  }
+};
+
+struct multi_board_cache_key {
+  /* See `basic_word_bank::lineage` */
+  uint64_t bank_lineage;
+  /* Sorted, as the cost of a state does not depend on the order of boards */
+  std::vector<word_list_hash> board_hashes;
+  bool is_hard_mode;
+  uint64_t guess_cost_function_address;
+  int num_attempts_allowed;
+  int num_attempts_used;
+  candidate_pruning_key pruning;
+
+  bool operator==(const multi_board_cache_key& other) const = default;
+};
+
+struct multi_board_cache_key_hasher {
+  uint64_t operator()(const multi_board_cache_key& key) const {
+    uint64_t combined_hash = key.bank_lineage;
+    for (const word_list_hash& board_hash : key.board_hashes) {
+      combined_hash = combined_hash * 31 + word_list_hash_hasher()(board_hash);
+    }
+    combined_hash = combined_hash * 31 + key.is_hard_mode;
+    combined_hash = combined_hash * 31 + key.guess_cost_function_address;
+    combined_hash = combined_hash * 31 + key.num_attempts_allowed;
+    combined_hash = combined_hash * 31 + key.num_attempts_used;
+    combined_hash =
+        combined_hash * 31 + hash_candidate_pruning_key(key.pruning);
+    return combined_hash;
+  }
+};
+
+/*
+  Besides the best guess for every joint state searched, the cache keeps the
+  entropy of every guess on a single board: a board appears in many joint
+  states (every verdict tuple sharing its verdict), and by independence the
+  entropy of a guess on a joint state is the sum of its per-board entropies.
+  In hard mode, boards are also searched on their own, with their results
+  kept in `board_cache` like those of any single-board search.
+*/
+struct multi_board_cache {
+  static constexpr int MAX_NUM_BOARD_ENTROPIES_CACHED = 1 << 10;
+
+  std::unordered_map<multi_board_cache_key, candidate_info,
+                     multi_board_cache_key_hasher>
+      best_guesses;
+  std::unordered_map<word_list_hash, std::shared_ptr<const std::vector<float>>,
+                     word_list_hash_hasher>
+      entropies_by_board;
+  std::shared_mutex mutex;
+  /* Counts joint states only; boards searched alone count in `board_cache` */
+  bot_stats stats;
+  bot_cache board_cache;
+};
+
+template <typename bank_type>
+static std::shared_ptr<const std::vector<float>> get_board_entropies(
+    const bank_type& bank, multi_board_cache& cache, word_list_view board,
+    const word_list_hash& board_hash) {
+  {
+    std::shared_lock lock(cache.mutex);
+    if (auto it = cache.entropies_by_board.find(board_hash);
+        it != cache.entropies_by_board.end()) {
+      return it->second;
+    }
+  }
+  /* Indexed by word id, as words may have been removed */
+  auto entropies = std::make_shared<std::vector<float>>(bank.num_ids);
+  for (int i = 0; i < bank.all_words.num_words; i++) {
+    int guess = bank.all_words.words[i];
+    (*entropies)[guess] = compute_guess_heuristic(bank, board, guess).entropy;
+  }
+  std::unique_lock lock(cache.mutex);
+  if (cache.entropies_by_board.size() >=
+      multi_board_cache::MAX_NUM_BOARD_ENTROPIES_CACHED) {
+    cache.entropies_by_board.clear();
+  }
+  cache.entropies_by_board[board_hash] = entropies;
+  return entropies;
+}
+
+/*
+  Searches a lone hard mode board with `find_best_guess`, which handles no
+  more than `MAX_NUM_ATTEMPTS_ALLOWED` attempts. A game allowing more is
+  searched as if its extra attempts had never been allowed, which under an
+  affine cost only takes the same amount off the cost of every target, and
+  nothing is returned when the cost is not affine or the board has too many
+  attempts left.
+*/
+template <typename bank_type>
+static std::optional<candidate_info> find_best_board_guess(
+    const bank_type& bank, multi_board_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, word_list_view board,
+    find_best_guess_callback_for_candidate callback_for_candidate,
+    const guess_cost_function& get_guess_cost,
+    candidate_pruning_policy pruning_policy) {
+  if (num_attempts_used >= num_attempts_allowed) {
+    return candidate_info{
+        .guess = board.words[0],
+        .cost = INFINITE_COST,
+    };
+  }
+  int num_attempts_skipped =
+      std::max(num_attempts_allowed - MAX_NUM_ATTEMPTS_ALLOWED, 0);
+  double skipped_cost = 0.0;
+  if (num_attempts_skipped > 0) {
+    std::optional<double> guess_cost_slope =
+        find_affine_guess_cost_slope(get_guess_cost);
+    if (!guess_cost_slope.has_value() ||
+        num_attempts_used < num_attempts_skipped) {
+      return std::nullopt;
+    }
+    for (int i = MAX_NUM_ATTEMPTS_ALLOWED; i < num_attempts_allowed; i++) {
+      if (get_guess_cost(i + 1) - get_guess_cost(i) !=
+          guess_cost_slope.value()) {
+        return std::nullopt;
+      }
+    }
+    skipped_cost = guess_cost_slope.value() * num_attempts_skipped;
+    /* So that every node keeps the pruning key it would have had */
+    pruning_policy.max_entropy_place_to_consider_for_initial_attempt =
+        std::nullopt;
+    pruning_policy.max_num_attempts_used_to_prune_by_two_attempt_entropy -=
+        num_attempts_skipped;
+  }
+  auto add_skipped_cost = [&board,
+                           skipped_cost](candidate_info& candidate) -> void {
+    if (candidate.cost < INFINITE_COST) {
+      candidate.cost += skipped_cost * board.num_targets;
+    }
+  };
+  find_best_guess_callback_for_candidate callback_for_board_candidate;
+  if (callback_for_candidate) {
+    callback_for_board_candidate = [&callback_for_candidate, &add_skipped_cost](
+                                       candidate_info candidate) -> void {
+      add_skipped_cost(candidate);
+      callback_for_candidate(candidate);
+    };
+  }
+  candidate_info best_guess = find_best_guess(
+      bank, cache.board_cache, num_attempts_allowed - num_attempts_skipped,
+      num_attempts_used - num_attempts_skipped, board,
+      callback_for_board_candidate, get_guess_cost, pruning_policy);
+  add_skipped_cost(best_guess);
+  return best_guess;
+}
+
+/*
+  A lower bound on what `board` adds to the cost of any state holding it,
+  per target combination of that state. A guess solves the board for at most
+  one of its targets, so every other target needs at least one more attempt
+  (assuming costs never decrease with attempts).
+*/
+static double compute_board_cost_lower_bound(
+    int num_attempts_used, word_list_view board,
+    const guess_cost_function& get_guess_cost) {
+  return (get_guess_cost(num_attempts_used + 1) +
+          (board.num_targets - 1) * get_guess_cost(num_attempts_used + 2)) /
+         board.num_targets;
+}
+
+/*
+  An estimate of the cost of playing `guess` as attempt number
+  `num_attempts_used` in a hard mode state, per target combination: the sum,
+  over boards, of the cost of solving each board alone after it, as far as
+  `find_best_board_guess` finds. The search of a lone board is pruned, so this
+  is no bound and only ranks candidates. Unknown if some board cannot be
+  searched alone.
+*/
+template <typename bank_type>
+static std::optional<double> estimate_hard_mode_guess_cost(
+    const bank_type& bank, multi_board_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, const multi_board_state& state, int guess,
+    const guess_cost_function& get_guess_cost,
+    candidate_pruning_policy pruning_policy) {
+  recycled_buffer<verdict_groups_for<bank_type>> recycled_groups;
+  verdict_groups_for<bank_type>& groups = *recycled_groups;
+  double estimate = 0.0;
+  for (word_list_view board : state.boards) {
+    group_remaining_words(groups, bank, board, guess);
+    for (int verdict = 0; verdict < bank_type::NUM_VERDICTS; verdict++) {
+      word_list_view group = groups[verdict];
+      if (group.num_targets == 0) {
+        continue;
+      }
+      if (verdict == bank_type::ALL_GREEN_VERDICT) {
+        estimate += get_guess_cost(num_attempts_used) / board.num_targets;
+        continue;
+      }
+      std::optional<candidate_info> best_guess = find_best_board_guess(
+          bank, cache, num_attempts_allowed, num_attempts_used, group, {},
+          get_guess_cost, pruning_policy);
+      if (!best_guess.has_value()) {
+        return std::nullopt;
+      }
+      estimate += best_guess.value().cost / board.num_targets;
+    }
+  }
+  return estimate;
+}
+
+/* The groups a guess splits one board into */
+template <typename bank_type>
+struct multi_board_split {
+  verdict_groups_for<bank_type> groups;
+  /* The verdicts showing some target, and the lower bounds of their groups */
+  std::vector<int> verdicts;
+  std::vector<double> lower_bounds;
+  /* Into `verdicts`, for the verdict tuple being visited */
+  int verdict_index;
+};
+
+template <typename bank_type>
+candidate_info find_best_multi_board_guess(
+    const bank_type& bank, multi_board_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, const multi_board_state& state,
+    find_best_guess_callback_for_candidate callback_for_candidate = {},
+    guess_cost_function get_guess_cost = get_flat_guess_cost,
+    candidate_pruning_policy pruning_policy =
+        default_candidate_pruning_policy);
+
+/*
+  Returns the cost of playing `guess` as attempt number `num_attempts_used`
+  (and the best play after it), or `INFINITE_COST` once the cost is known to
+  reach `cost_to_beat`
+*/
+template <typename bank_type>
+double evaluate_multi_board_guess(
+    const bank_type& bank, multi_board_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, const multi_board_state& state, int guess,
+    double cost_to_beat = INFINITE_COST,
+    guess_cost_function get_guess_cost = get_flat_guess_cost,
+    candidate_pruning_policy pruning_policy =
+        default_candidate_pruning_policy) {
+  int num_boards = state.boards.size();
+
+  /*
+    Every board keeps its split while the verdict tuples are searched, and the
+    search below needs splits of its own, so each call takes its own buffer.
+  */
+  recycled_buffer<std::vector<multi_board_split<bank_type>>> recycled_splits;
+  std::vector<multi_board_split<bank_type>>& splits = *recycled_splits;
+  if (splits.size() < num_boards) {
+    splits.resize(num_boards);
+  }
+  for (int b = 0; b < num_boards; b++) {
+    word_list_view board = state.boards[b];
+    multi_board_split<bank_type>& split = splits[b];
+    group_remaining_words(split.groups, bank, board, guess,
+                          !state.is_hard_mode);
+    /* A target is the first word of its group once per verdict */
+    split.verdicts.clear();
+    for (int i = 0; i < board.num_targets; i++) {
+      int verdict = bank.verdicts[guess][board.words[i]];
+      if (split.groups[verdict].words[0] == board.words[i]) {
+        split.verdicts.push_back(verdict);
+      }
+    }
+    std::sort(split.verdicts.begin(), split.verdicts.end(), std::greater());
+    split.lower_bounds.clear();
+    for (int verdict : split.verdicts) {
+      if (verdict == bank_type::ALL_GREEN_VERDICT) {
+        split.lower_bounds.push_back(0.0);
+        continue;
+      }
+      if (num_attempts_used == num_attempts_allowed) {
+        return INFINITE_COST;
+      }
+      split.lower_bounds.push_back(compute_board_cost_lower_bound(
+          num_attempts_used, split.groups[verdict], get_guess_cost));
+    }
+    split.verdict_index = 0;
+  }
+
+  recycled_buffer<multi_board_state> recycled_child_state;
+  multi_board_state& child_state = *recycled_child_state;
+  child_state.is_hard_mode = state.is_hard_mode;
+  /*
+    Leaves the boards still unsolved under the current verdict tuple in
+    `child_state`, and sets the exact cost of the boards it solves and a lower
+    bound on the cost of the others
+  */
+  auto visit_verdict_tuple = [&](double& out_solved_cost,
+                                 double& out_unsolved_lower_bound) -> void {
+    child_state.boards.clear();
+    int num_boards_solved = 0;
+    double num_combinations = 1.0;
+    double lower_bound_per_combination = 0.0;
+    for (int b = 0; b < num_boards; b++) {
+      const multi_board_split<bank_type>& split = splits[b];
+      int verdict = split.verdicts[split.verdict_index];
+      word_list_view group = split.groups[verdict];
+      num_combinations *= group.num_targets;
+      if (verdict == bank_type::ALL_GREEN_VERDICT) {
+        num_boards_solved++;
+        continue;
+      }
+      lower_bound_per_combination += split.lower_bounds[split.verdict_index];
+      child_state.boards.push_back(group);
+    }
+    out_solved_cost = num_boards_solved * num_combinations *
+                      get_guess_cost(num_attempts_used);
+    out_unsolved_lower_bound = lower_bound_per_combination * num_combinations;
+  };
+  auto advance_to_next_verdict_tuple = [&]() -> bool {
+    for (int b = num_boards - 1; b >= 0; b--) {
+      multi_board_split<bank_type>& split = splits[b];
+      split.verdict_index++;
+      if (split.verdict_index < split.verdicts.size()) {
+        return true;
+      }
+      split.verdict_index = 0;
+    }
+    return false;
+  };
+
+  double remaining_lower_bound = 0.0;
+  do {
+    double solved_cost;
+    double unsolved_lower_bound;
+    visit_verdict_tuple(solved_cost, unsolved_lower_bound);
+    remaining_lower_bound += solved_cost + unsolved_lower_bound;
+  } while (advance_to_next_verdict_tuple());
+  if (remaining_lower_bound >= cost_to_beat) {
+    return INFINITE_COST;
+  }
+
+  double cost = 0.0;
+  do {
+    double solved_cost;
+    double unsolved_lower_bound;
+    visit_verdict_tuple(solved_cost, unsolved_lower_bound);
+    cost += solved_cost;
+    remaining_lower_bound -= solved_cost + unsolved_lower_bound;
+    if (child_state.boards.empty()) {
+      continue;
+    }
+    candidate_info best_guess = find_best_multi_board_guess(
+        bank, cache, num_attempts_allowed, num_attempts_used, child_state, {},
+        get_guess_cost, pruning_policy);
+    if (best_guess.cost >= INFINITE_COST) {
+      return INFINITE_COST;
+    }
+    cost += best_guess.cost;
+    if (cost + remaining_lower_bound >= cost_to_beat) {
+      return INFINITE_COST;
+    }
+  } while (advance_to_next_verdict_tuple());
+  return cost;
+}
+
+/*
+  Candidates are the words with the highest entropy on the joint state, plus
+  every remaining target of boards small enough that solving them outright
+  matters more than splitting them; in hard mode, only the words valid on
+  every board are. Candidates whose cost is cut off by a better candidate
+  found earlier are not passed to `callback_for_candidate`. In hard mode,
+  candidates are tried by `estimate_hard_mode_guess_cost`, and a state down to
+  one board is searched by `find_best_board_guess` where it can be, as it is
+  then a single-board state. As candidates are pruned, the cost returned is
+  that of the best strategy found, which may miss the optimum.
+*/
+template <typename bank_type>
+candidate_info find_best_multi_board_guess(
+    const bank_type& bank, multi_board_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, const multi_board_state& state,
+    find_best_guess_callback_for_candidate callback_for_candidate,
+    guess_cost_function get_guess_cost,
+    candidate_pruning_policy pruning_policy) {
+  const std::vector<word_list_view>& boards = state.boards;
+  if (num_attempts_used >= num_attempts_allowed) {
+    return candidate_info{
+        .guess = boards[0].words[0],
+        .cost = INFINITE_COST,
+    };
+  }
+  if (boards.size() == 1 && state.is_hard_mode) {
+    std::optional<candidate_info> best_guess = find_best_board_guess(
+        bank, cache, num_attempts_allowed, num_attempts_used, boards[0],
+        callback_for_candidate, get_guess_cost, pruning_policy);
+    if (best_guess.has_value()) {
+      return best_guess.value();
+    }
+  }
+  if (boards.size() == 1 && boards[0].num_targets <= 2) {
+    int num_targets = boards[0].num_targets;
+    return candidate_info{
+        .guess = boards[0].words[0],
+        .cost = num_attempts_used + num_targets > num_attempts_allowed
+                    ? INFINITE_COST
+                    : get_guess_cost(num_attempts_used + 1) +
+                          (num_targets == 2) *
+                              get_guess_cost(num_attempts_used + 2),
+    };
+  }
+
+  std::vector<word_list_hash> board_hashes;
+  for (word_list_view board : boards) {
+    board_hashes.push_back(hash_word_list(board, get_root_words(bank)));
+  }
+  candidate_pruning_key pruning =
+      get_candidate_pruning_key(pruning_policy, num_attempts_used);
+  int max_entropy_place_to_consider =
+      num_attempts_used == 0 &&
+              pruning_policy.max_entropy_place_to_consider_for_initial_attempt
+                  .has_value()
+          ? pruning_policy.max_entropy_place_to_consider_for_initial_attempt
+                .value()
+          : pruning_policy.max_entropy_place_to_consider;
+  multi_board_cache_key cache_key = {
+      .bank_lineage = bank.lineage,
+      .board_hashes = board_hashes,
+      .is_hard_mode = state.is_hard_mode,
+      .guess_cost_function_address = get_function_address(get_guess_cost),
+      .num_attempts_allowed = num_attempts_allowed,
+      .num_attempts_used = num_attempts_used,
+      .pruning = pruning,
+  };
+  std::sort(cache_key.board_hashes.begin(), cache_key.board_hashes.end());
+  if (!callback_for_candidate) {
+    std::shared_lock lock(cache.mutex);
+    if (auto it = cache.best_guesses.find(cache_key);
+        it != cache.best_guesses.end()) {
+      cache.stats.num_cache_hits.fetch_add(1, std::memory_order_relaxed);
+      return it->second;
+    }
+  }
+  cache.stats.num_nodes_searched.fetch_add(1, std::memory_order_relaxed);
+
+  std::vector<int> num_boards_valid_on(bank.num_ids);
+  if (state.is_hard_mode) {
+    for (word_list_view board : boards) {
+      for (int i = 0; i < board.num_words; i++) {
+        num_boards_valid_on[board.words[i]]++;
+      }
+    }
+  }
+  auto is_valid = [&state, &num_boards_valid_on, &boards](int guess) -> bool {
+    return !state.is_hard_mode ||
+           num_boards_valid_on[guess] == static_cast<int>(boards.size());
+  };
+  std::vector<int> candidates;
+  for (int i = 0; i < bank.all_words.num_words; i++) {
+    if (is_valid(bank.all_words.words[i])) {
+      candidates.push_back(bank.all_words.words[i]);
+    }
+  }
+  if (candidates.empty()) {
+    return candidate_info{
+        .guess = boards[0].words[0],
+        .cost = INFINITE_COST,
+    };
+  }
+
+  std::vector<float> joint_entropies(bank.num_ids);
+  for (int b = 0; b < boards.size(); b++) {
+    std::shared_ptr<const std::vector<float>> entropies =
+        get_board_entropies(bank, cache, boards[b], board_hashes[b]);
+    for (int guess : candidates) {
+      joint_entropies[guess] += (*entropies)[guess];
+    }
+  }
+  auto is_more_promising = [&joint_entropies](int a, int b) -> bool {
+    return joint_entropies[a] != joint_entropies[b]
+               ? joint_entropies[a] > joint_entropies[b]
+               : a < b;
+  };
+  int num_candidates_by_entropy =
+      std::min<int>(max_entropy_place_to_consider, candidates.size());
+  std::partial_sort(candidates.begin(),
+                    candidates.begin() + num_candidates_by_entropy,
+                    candidates.end(), is_more_promising);
+  candidates.resize(num_candidates_by_entropy);
+  for (word_list_view board : boards) {
+    if (board.num_targets > max_entropy_place_to_consider) {
+      continue;
+    }
+    std::copy_if(board.words, board.words + board.num_targets,
+                 std::back_inserter(candidates), is_valid);
+  }
+  std::sort(candidates.begin(), candidates.end(), is_more_promising);
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+  if (state.is_hard_mode) {
+    /* Tried by estimated cost, so that the cutoffs below bite early */
+    std::vector<double> estimated_costs(bank.num_ids);
+    bool is_every_cost_estimated = true;
+    for (int guess : candidates) {
+      std::optional<double> estimated_cost = estimate_hard_mode_guess_cost(
+          bank, cache, num_attempts_allowed, num_attempts_used + 1, state,
+          guess, get_guess_cost, pruning_policy);
+      if (!estimated_cost.has_value()) {
+        is_every_cost_estimated = false;
+        break;
+      }
+      estimated_costs[guess] = estimated_cost.value();
+    }
+    if (is_every_cost_estimated) {
+      std::stable_sort(candidates.begin(), candidates.end(),
+                       [&estimated_costs](int a, int b) -> bool {
+                         return estimated_costs[a] < estimated_costs[b];
+                       });
+    }
+  }
+
+  candidate_info best_guess = {
+      .guess = candidates[0],
+      .cost = INFINITE_COST,
+  };
+  for (int guess : candidates) {
+    cache.stats.num_guesses_evaluated.fetch_add(1, std::memory_order_relaxed);
+    double cost = evaluate_multi_board_guess(
+        bank, cache, num_attempts_allowed, num_attempts_used + 1, state, guess,
+        best_guess.cost, get_guess_cost, pruning_policy);
+    if (cost >= INFINITE_COST) {
+      continue;
+    }
+    if (callback_for_candidate) {
+      callback_for_candidate(candidate_info{
+          .guess = guess,
+          .cost = cost,
+      });
+    }
+    if (cost < best_guess.cost) {
+      best_guess = {
+          .guess = guess,
+          .cost = cost,
+      };
+    }
+  }
+
+  std::unique_lock lock(cache.mutex);
+  cache.best_guesses[cache_key] = best_guess;
+  return best_guess;
+}
+
+}  // namespace wordy_witch
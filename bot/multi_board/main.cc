@@ -0,0 +1,195 @@
+/*
+  Finds the best next guess for a multi-board (Dordle, Quordle, ...) state.
+
+  Flags (each followed by a value):
+    --bank-root    directory holding the banks (default `../../bank`)
+    --bank         bank whose words are guessed (default `co_wordle`)
+    --guesses      `targets`, `common` (default) or `all`
+    --boards       number of boards (default 2)
+    --attempts     number of attempts allowed (default: boards + 5)
+    --cost         `flat` (default) or `penalty`
+    --places       `max_entropy_place_to_consider` (default 32)
+    --hard-mode    `1` for every guess to be valid under hard mode on every
+                   board not solved yet (default `0`)
+    --state        comma-separated guesses and verdicts, with the verdict
+                   tiles of every board separated by `/`, e.g.
+                   `LEAST,-^--#/#----`
+
+  Searching from the initial state is out of reach; Dordle and Quordle states
+  are tractable after about two guesses. The search is heuristic, as
+  candidates are pruned by entropy. In hard mode, boards whose verdicts
+  contradict each other leave no valid guess, so most states cost infinity
+  unless their boards agree so far.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../bot.hh"
+#include "../cli.hh"
+#include "../log.hh"
+#include "../multi_board.hh"
+
+int main(int argc, char** argv) {
+  std::map<std::string, std::string> flags = {
+      {"--bank-root", "../../bank"},
+      {"--bank", "co_wordle"},
+      {"--guesses", wordy_witch::INCLUDE_COMMON_WORDS_ONLY},
+      {"--boards", "2"},
+      {"--cost", "flat"},
+      {"--places", "32"},
+      {"--hard-mode", "0"},
+      {"--state", ""},
+  };
+  std::optional<std::string> flag_error =
+      wordy_witch::parse_flags(flags, {"--attempts"}, argc, argv);
+  if (flag_error.has_value()) {
+    std::cerr << flag_error.value() << std::endl;
+    return 1;
+  }
+  bool is_hard_mode = flags["--hard-mode"] == "1";
+  int num_boards = std::stoi(flags["--boards"]);
+  int num_attempts_allowed = flags.count("--attempts") > 0
+                                 ? std::stoi(flags["--attempts"])
+                                 : num_boards + 5;
+
+  static wordy_witch::word_bank bank;
+  if (!wordy_witch::read_bank(
+          bank, std::filesystem::path(flags["--bank-root"]) / flags["--bank"],
+          flags["--guesses"])) {
+    std::cerr << "Cannot load bank " << flags["--bank"] << std::endl;
+    return 1;
+  }
+  WORDY_WITCH_TRACE("Done bank loading");
+
+  std::optional<wordy_witch::guess_cost_function> get_guess_cost =
+      wordy_witch::find_guess_cost_function(flags["--cost"]);
+  if (!get_guess_cost.has_value()) {
+    std::cerr << "Unknown cost " << flags["--cost"] << std::endl;
+    return 1;
+  }
+  wordy_witch::candidate_pruning_policy pruning_policy = {
+      .max_entropy_place_to_consider = std::stoi(flags["--places"]),
+  };
+
+  std::vector<std::unique_ptr<wordy_witch::word_list>> board_storage;
+  std::vector<bool> is_board_solved(num_boards);
+  for (int b = 0; b < num_boards; b++) {
+    board_storage.push_back(
+        std::make_unique_for_overwrite<wordy_witch::word_list>());
+    wordy_witch::list_all_words(*board_storage[b], bank);
+    if (!is_hard_mode) {
+      board_storage[b]->num_words = bank.num_targets;
+    }
+  }
+  std::vector<std::string> state;
+  std::istringstream state_words(flags["--state"]);
+  for (std::string word; std::getline(state_words, word, ',');) {
+    state.push_back(word);
+  }
+  for (int i = 1; i < state.size(); i += 2) {
+    std::optional<int> guess =
+        wordy_witch::find_word(bank, wordy_witch::to_upper(state[i - 1]));
+    if (!guess.has_value()) {
+      std::cerr << "Unknown word " << state[i - 1] << std::endl;
+      return 1;
+    }
+    std::istringstream tiles_by_board(state[i]);
+    for (int b = 0; b < num_boards; b++) {
+      std::string tiles;
+      std::getline(tiles_by_board, tiles, '/');
+      std::optional<int> verdict = wordy_witch::parse_verdict(tiles);
+      if (!verdict.has_value()) {
+        std::cerr << "Invalid verdict " << tiles << " on board " << b + 1
+                  << std::endl;
+        return 1;
+      }
+      if (is_board_solved[b]) {
+        continue;
+      }
+      wordy_witch::word_list& board = *board_storage[b];
+      if (is_hard_mode && std::find(board.words, board.words + board.num_words,
+                                    guess.value()) ==
+                              board.words + board.num_words) {
+        std::cerr << state[i - 1] << " is not valid on board " << b + 1
+                  << " under hard mode" << std::endl;
+        return 1;
+      }
+      wordy_witch::apply_verdict(board, bank, guess.value(), verdict.value());
+      if (!is_hard_mode) {
+        board.num_words = board.num_targets;
+      }
+      if (board.num_targets == 0) {
+        std::cerr << "No target is left on board " << b + 1 << std::endl;
+        return 1;
+      }
+      is_board_solved[b] =
+          verdict.value() == wordy_witch::word_bank::ALL_GREEN_VERDICT;
+    }
+  }
+  wordy_witch::multi_board_state boards = {.is_hard_mode = is_hard_mode};
+  for (int b = 0; b < num_boards; b++) {
+    if (!is_board_solved[b]) {
+      boards.boards.push_back(*board_storage[b]);
+    }
+  }
+  if (boards.boards.empty()) {
+    std::cout << "Every board is solved" << std::endl;
+    return 0;
+  }
+
+  double num_combinations = 1.0;
+  std::cout << std::setprecision(4);
+  std::cout << "Remaining targets by board:";
+  for (wordy_witch::word_list_view board : boards.boards) {
+    std::cout << " " << board.num_targets;
+    num_combinations *= board.num_targets;
+  }
+  std::cout << std::endl;
+  std::cout << "(EC: the expected cost for a possible remaining game; this is "
+               "equal to `Cost` divided by the number of remaining target "
+               "combinations)"
+            << std::endl;
+  std::cout << "(The search is heuristic: candidates are pruned by entropy, so "
+               "costs are those of the best strategies found, which may miss "
+               "the optimum)"
+            << std::endl;
+  std::cout << "Guess\tCost\tEC" << std::endl;
+
+  static wordy_witch::multi_board_cache cache;
+  auto start_time = std::chrono::steady_clock::now();
+  wordy_witch::candidate_info best_guess =
+      wordy_witch::find_best_multi_board_guess(
+          bank, cache, num_attempts_allowed, state.size() / 2, boards,
+          [&num_combinations](wordy_witch::candidate_info candidate) -> void {
+            std::cout << bank.words[candidate.guess] << "\t" << candidate.cost
+                      << "\t" << candidate.cost / num_combinations
+                      << std::endl;
+          },
+          get_guess_cost.value(), pruning_policy);
+  std::cout << std::endl;
+  std::cout << "Best guess in the input board state: "
+            << bank.words[best_guess.guess] << " (Cost: " << best_guess.cost
+            << ", EC: " << best_guess.cost / num_combinations << ")"
+            << std::endl;
+  std::cout << "Searched " << cache.stats.num_nodes_searched
+            << " joint states (" << cache.stats.num_guesses_evaluated
+            << " guesses evaluated, " << cache.stats.num_cache_hits
+            << " cache hits) and "
+            << cache.board_cache.stats.num_nodes_searched
+            << " single boards in "
+            << std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             start_time)
+                   .count()
+            << "s" << std::endl;
+}
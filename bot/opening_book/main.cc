@@ -0,0 +1,178 @@
+/*
+  Builds the opening book of banks offline: the `find_best_guess` results at
+  the root and after every verdict of a fixed opener, written to
+  `OPENING_BOOK_FILE_NAME` in the bank directory. Entries already in the book
+  for other settings are kept; those for the same settings are replaced.
+
+  Flags (each followed by a value):
+    --bank-root        directory holding the banks (default `../../bank`)
+    --banks            comma-separated banks (default
+                       `co_wordle,co_wordle_unlimited`)
+    --guesses          comma-separated guess inclusions among `targets`,
+                       `common` and `all` (default `common`)
+    --costs            comma-separated cost models (default `flat`)
+    --places           `max_entropy_place_to_consider` (default 32)
+    --initial-places   `max_entropy_place_to_consider_for_initial_attempt`
+    --opener           opener whose replies are precomputed (default `LEAST`)
+    --threads          number of threads searching (default: all cores)
+*/
+
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../bot.hh"
+#include "../cli.hh"
+#include "../log.hh"
+#include "../work_stealing.hh"
+
+std::vector<std::string> split(const std::string& text, char delimiter) {
+  std::vector<std::string> parts;
+  std::istringstream stream(text);
+  for (std::string part; std::getline(stream, part, delimiter);) {
+    parts.push_back(part);
+  }
+  return parts;
+}
+
+int main(int argc, char** argv) {
+  std::map<std::string, std::string> flags = {
+      {"--bank-root", "../../bank"},
+      {"--banks", "co_wordle,co_wordle_unlimited"},
+      {"--guesses", wordy_witch::INCLUDE_COMMON_WORDS_ONLY},
+      {"--costs", "flat"},
+      {"--places", "32"},
+      {"--opener", "LEAST"},
+      {"--threads",
+       std::to_string(std::max(1U, std::thread::hardware_concurrency()))},
+  };
+  std::optional<std::string> flag_error =
+      wordy_witch::parse_flags(flags, {"--initial-places"}, argc, argv);
+  if (flag_error.has_value()) {
+    std::cerr << flag_error.value() << std::endl;
+    return 1;
+  }
+  wordy_witch::candidate_pruning_policy pruning_policy = {
+      .max_entropy_place_to_consider = std::stoi(flags["--places"]),
+  };
+  if (flags.count("--initial-places") > 0) {
+    pruning_policy.max_entropy_place_to_consider_for_initial_attempt =
+        std::stoi(flags["--initial-places"]);
+  }
+  std::string opener = wordy_witch::to_upper(flags["--opener"]);
+  wordy_witch::work_stealing_pool pool(std::stoi(flags["--threads"]));
+
+  for (const std::string& bank_name : split(flags["--banks"], ',')) {
+    std::filesystem::path bank_path =
+        std::filesystem::path(flags["--bank-root"]) / bank_name;
+    std::filesystem::path opening_book_path =
+        bank_path / wordy_witch::OPENING_BOOK_FILE_NAME;
+    std::vector<wordy_witch::opening_book_entry> entries;
+    wordy_witch::read_opening_book_entries(entries, opening_book_path);
+
+    for (const std::string& guesses_inclusion :
+         split(flags["--guesses"], ',')) {
+      std::unique_ptr<wordy_witch::word_bank> bank =
+          std::make_unique_for_overwrite<wordy_witch::word_bank>();
+      if (!wordy_witch::read_bank(*bank, bank_path, guesses_inclusion)) {
+        std::cerr << "Cannot load bank " << bank_name << std::endl;
+        return 1;
+      }
+      std::optional<int> opener_word = wordy_witch::find_word(*bank, opener);
+      if (!opener_word.has_value()) {
+        std::cerr << "Unknown opener " << opener << " in " << bank_name
+                  << std::endl;
+        return 1;
+      }
+      WORDY_WITCH_TRACE("Done bank loading", bank_name, guesses_inclusion);
+
+      for (const std::string& cost_model : split(flags["--costs"], ',')) {
+        std::optional<wordy_witch::guess_cost_function> get_guess_cost =
+            wordy_witch::find_guess_cost_function(cost_model);
+        if (!get_guess_cost.has_value()) {
+          std::cerr << "Unknown cost " << cost_model << std::endl;
+          return 1;
+        }
+        std::unique_ptr<wordy_witch::bot_cache> cache =
+            std::make_unique<wordy_witch::bot_cache>();
+
+        std::vector<std::vector<std::string>> states = {{}};
+        static wordy_witch::verdict_groups groups;
+        static wordy_witch::word_list all_words;
+        wordy_witch::list_all_words(all_words, *bank);
+        wordy_witch::group_remaining_words(groups, *bank, all_words,
+                                           opener_word.value());
+        for (int verdict = 0; verdict < wordy_witch::word_bank::NUM_VERDICTS;
+             verdict++) {
+          if (groups[verdict].num_targets > 0 &&
+              verdict != wordy_witch::word_bank::ALL_GREEN_VERDICT) {
+            states.push_back({opener, wordy_witch::format_verdict(verdict)});
+          }
+        }
+
+        std::vector<wordy_witch::opening_book_entry> new_entries(
+            states.size());
+        auto search_state = [&](int i) -> void {
+          /*
+            Not a per-thread buffer: this thread runs other states while the
+            search below waits for its tasks.
+          */
+          wordy_witch::recycled_buffer<wordy_witch::word_list>
+              recycled_remaining_words;
+          wordy_witch::word_list& remaining_words = *recycled_remaining_words;
+          wordy_witch::apply_board_state(remaining_words, *bank, states[i]);
+          wordy_witch::candidate_info best_guess = wordy_witch::find_best_guess(
+              *bank, *cache, wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED,
+              states[i].size() / 2, remaining_words, {},
+              get_guess_cost.value(), pruning_policy);
+          new_entries[i] = {
+              .bank_hash = bank->hash,
+              .cost_model = cost_model,
+              .pruning_policy = pruning_policy,
+              .num_attempts_allowed = wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED,
+              .state = states[i],
+              .best_guess = bank->words[best_guess.guess],
+              .cost = best_guess.cost,
+          };
+          WORDY_WITCH_TRACE("Done state", bank_name, guesses_inclusion,
+                            cost_model, i, states.size());
+        };
+        /*
+          The root comes first on its own: it is the longest search, and the
+          replies reuse most of what it caches.
+        */
+        wordy_witch::run_in_work_stealing_pool(pool, [&]() -> void {
+          search_state(0);
+          wordy_witch::task_group tasks;
+          for (int i = states.size() - 1; i >= 1; i--) {
+            wordy_witch::spawn_task(
+                tasks, [&search_state, i]() -> void { search_state(i); });
+          }
+          wordy_witch::wait_for_tasks(tasks);
+        });
+
+        for (const wordy_witch::opening_book_entry& new_entry : new_entries) {
+          std::string key =
+              wordy_witch::format_opening_book_entry_key(new_entry);
+          std::erase_if(entries,
+                        [&key](const wordy_witch::opening_book_entry& entry)
+                            -> bool {
+                          return wordy_witch::format_opening_book_entry_key(
+                                     entry) == key;
+                        });
+          entries.push_back(new_entry);
+        }
+      }
+    }
+
+    wordy_witch::write_opening_book_entries(opening_book_path, entries);
+    WORDY_WITCH_TRACE("Done opening book", opening_book_path.string(),
+                      entries.size());
+  }
+}
@@ -0,0 +1,254 @@
+/*
+  Sweeps candidate pruning policies over a fixed set of board states and
+  reports, for every policy, the wall time, the number of nodes searched and
+  how far the costs found are above those of a high-effort reference policy.
+  Policies on the Pareto frontier of time against excess cost are marked, so
+  that settings can be picked for each latency tier.
+
+  Flags (each followed by a value):
+    --bank-root      directory holding the banks (default `../../bank`)
+    --guesses        `targets`, `common` (default) or `all`
+    --cost           `flat` (default) or `penalty`
+    --places         comma-separated `max_entropy_place_to_consider` values
+                     (default `8,16,32,64`)
+    --differences    comma-separated `max_entropy_difference_to_consider`
+                     values (default `0.5,1,2`)
+    --two-attempts   comma-separated
+                     `max_num_attempts_used_to_prune_by_two_attempt_entropy`
+                     values, -1 to never prune by two-attempt entropy
+                     (default `-1,1,2`)
+    --reference      the reference policy as `places,difference,two_attempts`
+                     (default `128,2,-1`)
+    --states         `;`-separated board states, each as `bank:state` with the
+                     state as in `cli.hh` (default: a fixed set over
+                     `co_wordle` and `co_wordle_unlimited`)
+*/
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../bot.hh"
+#include "../cli.hh"
+#include "../log.hh"
+
+struct board_state {
+  std::string bank_name;
+  std::string description;
+  const wordy_witch::word_bank* bank;
+  std::unique_ptr<wordy_witch::word_list> remaining_words;
+  int num_attempts_used;
+};
+
+struct policy_result {
+  wordy_witch::candidate_pruning_policy pruning_policy;
+  double seconds_elapsed;
+  int64_t num_nodes_searched;
+  std::vector<double> costs;
+  double excess_cost;
+  int num_states_at_reference_cost;
+  bool is_on_frontier;
+};
+
+std::vector<std::string> split(const std::string& text, char delimiter) {
+  std::vector<std::string> parts;
+  std::istringstream stream(text);
+  for (std::string part; std::getline(stream, part, delimiter);) {
+    parts.push_back(part);
+  }
+  return parts;
+}
+
+policy_result run_policy(const std::vector<board_state>& states,
+                         wordy_witch::guess_cost_function get_guess_cost,
+                         wordy_witch::candidate_pruning_policy pruning_policy) {
+  std::unique_ptr<wordy_witch::bot_cache> cache =
+      std::make_unique<wordy_witch::bot_cache>();
+  policy_result result = {.pruning_policy = pruning_policy};
+  auto start_time = std::chrono::steady_clock::now();
+  for (const board_state& state : states) {
+    wordy_witch::candidate_info best_guess = wordy_witch::find_best_guess(
+        *state.bank, *cache, wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED,
+        state.num_attempts_used, *state.remaining_words, {}, get_guess_cost,
+        pruning_policy);
+    result.costs.push_back(best_guess.cost);
+  }
+  result.seconds_elapsed = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start_time)
+                               .count();
+  result.num_nodes_searched = cache->stats.num_nodes_searched;
+  return result;
+}
+
+int main(int argc, char** argv) {
+  std::map<std::string, std::string> flags = {
+      {"--bank-root", "../../bank"},
+      {"--guesses", wordy_witch::INCLUDE_COMMON_WORDS_ONLY},
+      {"--cost", "flat"},
+      {"--places", "8,16,32,64"},
+      {"--differences", "0.5,1,2"},
+      {"--two-attempts", "-1,1,2"},
+      {"--reference", "128,2,-1"},
+      {"--states",
+       "co_wordle:LEAST,-^--#;"
+       "co_wordle:LEAST,#----;"
+       "co_wordle:LEAST,--^-^;"
+       "co_wordle:LEAST,-----;"
+       "co_wordle_unlimited:LEAST,---^-;"
+       "co_wordle_unlimited:CRANE,-^--#;"
+       "co_wordle_unlimited:CRANE,-----;"
+       "co_wordle_unlimited:CRANE,^----,LOUSY,--^--"},
+  };
+  std::optional<std::string> flag_error =
+      wordy_witch::parse_flags(flags, {}, argc, argv);
+  if (flag_error.has_value()) {
+    std::cerr << flag_error.value() << std::endl;
+    return 1;
+  }
+
+  std::optional<wordy_witch::guess_cost_function> get_guess_cost =
+      wordy_witch::find_guess_cost_function(flags["--cost"]);
+  if (!get_guess_cost.has_value()) {
+    std::cerr << "Unknown cost " << flags["--cost"] << std::endl;
+    return 1;
+  }
+  std::vector<std::string> reference = split(flags["--reference"], ',');
+  if (reference.size() != 3) {
+    std::cerr << "Invalid reference " << flags["--reference"] << std::endl;
+    return 1;
+  }
+  wordy_witch::candidate_pruning_policy reference_policy = {
+      .max_entropy_place_to_consider = std::stoi(reference[0]),
+      .max_entropy_difference_to_consider = std::stod(reference[1]),
+      .max_num_attempts_used_to_prune_by_two_attempt_entropy =
+          std::stoi(reference[2]),
+  };
+
+  std::map<std::string, std::unique_ptr<wordy_witch::word_bank>> banks;
+  std::vector<board_state> states;
+  for (const std::string& spec : split(flags["--states"], ';')) {
+    size_t separator = spec.find(':');
+    if (separator == std::string::npos) {
+      std::cerr << "Invalid state " << spec << std::endl;
+      return 1;
+    }
+    std::string bank_name = spec.substr(0, separator);
+    std::unique_ptr<wordy_witch::word_bank>& bank = banks[bank_name];
+    if (bank == nullptr) {
+      bank = std::make_unique_for_overwrite<wordy_witch::word_bank>();
+      if (!wordy_witch::read_bank(
+              *bank, std::filesystem::path(flags["--bank-root"]) / bank_name,
+              flags["--guesses"])) {
+        std::cerr << "Cannot load bank " << bank_name << std::endl;
+        return 1;
+      }
+      WORDY_WITCH_TRACE("Done bank loading", bank_name);
+    }
+    std::vector<std::string> state = split(spec.substr(separator + 1), ',');
+    if (state.size() % 2 == 1) {
+      std::cerr << "State " << spec << " does not end with a verdict"
+                << std::endl;
+      return 1;
+    }
+    board_state& board = states.emplace_back(board_state{
+        .bank_name = bank_name,
+        .description = spec,
+        .bank = bank.get(),
+        .remaining_words =
+            std::make_unique_for_overwrite<wordy_witch::word_list>(),
+        .num_attempts_used = static_cast<int>(state.size() / 2),
+    });
+    std::optional<std::string> error = wordy_witch::apply_board_state(
+        *board.remaining_words, *bank, state);
+    if (error.has_value()) {
+      std::cerr << "Invalid state " << spec << ": " << error.value()
+                << std::endl;
+      return 1;
+    }
+  }
+
+  policy_result reference_result =
+      run_policy(states, get_guess_cost.value(), reference_policy);
+  WORDY_WITCH_TRACE("Done reference policy");
+  std::cout << std::setprecision(4);
+  std::cout << "Reference costs (" << flags["--reference"] << ", "
+            << reference_result.seconds_elapsed << "s, "
+            << reference_result.num_nodes_searched << " nodes):" << std::endl;
+  for (int i = 0; i < states.size(); i++) {
+    std::cout << states[i].description << "\t" << reference_result.costs[i]
+              << std::endl;
+  }
+  std::cout << std::endl;
+
+  std::vector<policy_result> results;
+  for (const std::string& places : split(flags["--places"], ',')) {
+    for (const std::string& difference : split(flags["--differences"], ',')) {
+      for (const std::string& two_attempts :
+           split(flags["--two-attempts"], ',')) {
+        wordy_witch::candidate_pruning_policy pruning_policy = {
+            .max_entropy_place_to_consider = std::stoi(places),
+            .max_entropy_difference_to_consider = std::stod(difference),
+            .max_num_attempts_used_to_prune_by_two_attempt_entropy =
+                std::stoi(two_attempts),
+        };
+        policy_result result =
+            run_policy(states, get_guess_cost.value(), pruning_policy);
+        for (int i = 0; i < states.size(); i++) {
+          result.excess_cost += result.costs[i] - reference_result.costs[i];
+          result.num_states_at_reference_cost +=
+              result.costs[i] <= reference_result.costs[i];
+        }
+        WORDY_WITCH_TRACE("Done policy", places, difference, two_attempts);
+        results.push_back(result);
+      }
+    }
+  }
+
+  for (policy_result& result : results) {
+    result.is_on_frontier = true;
+    for (const policy_result& other : results) {
+      bool is_no_worse = other.seconds_elapsed <= result.seconds_elapsed &&
+                         other.excess_cost <= result.excess_cost;
+      bool is_better = other.seconds_elapsed < result.seconds_elapsed ||
+                       other.excess_cost < result.excess_cost;
+      if (is_no_worse && is_better) {
+        result.is_on_frontier = false;
+        break;
+      }
+    }
+  }
+  std::sort(results.begin(), results.end(),
+            [](const policy_result& a, const policy_result& b) -> bool {
+              return a.seconds_elapsed < b.seconds_elapsed;
+            });
+
+  std::cout << "(Excess: total cost above the reference over all states)"
+            << std::endl;
+  std::cout << "(Exact: number of states solved at the reference cost)"
+            << std::endl;
+  std::cout << "(Frontier: `*` if no other policy is both faster and closer "
+               "to the reference)"
+            << std::endl;
+  std::cout << "Places\tDifference\tTwoAttempts\tSeconds\tNodes\tExcess\tExact"
+               "\tFrontier"
+            << std::endl;
+  for (const policy_result& result : results) {
+    const wordy_witch::candidate_pruning_policy& policy =
+        result.pruning_policy;
+    std::cout << policy.max_entropy_place_to_consider << "\t"
+              << policy.max_entropy_difference_to_consider << "\t"
+              << policy.max_num_attempts_used_to_prune_by_two_attempt_entropy
+              << "\t" << result.seconds_elapsed << "\t"
+              << result.num_nodes_searched << "\t" << result.excess_cost
+              << "\t" << result.num_states_at_reference_cost << "/"
+              << states.size() << "\t" << (result.is_on_frontier ? "*" : "")
+              << std::endl;
+  }
+}
@@ -0,0 +1,193 @@
+/*
+  Ranks every guess of a bank as an opener, by what `evaluate_guess` costs it
+  at the first attempt, and prints the ranking once every opener is done.
+
+  Openers are evaluated as tasks of one work stealing pool, sharing one bot
+  cache, the most informative ones first. Each result is appended to the
+  checkpoint file as soon as it is known, and a run finding a checkpoint
+  skips the openers it lists, so an interrupted ranking resumes where it
+  stopped. The first line of the checkpoint records the settings, which a
+  resumed run must share; a last line cut short by the interruption is
+  dropped.
+
+  Flags (each followed by a value):
+    --bank-root    directory holding the banks (default `../../bank`)
+    --bank         bank to rank the openers of (default `co_wordle`)
+    --guesses      `targets`, `common` or `all` (default)
+    --cost         `flat` (default) or `penalty`
+    --places       `max_entropy_place_to_consider` (default 32)
+    --checkpoint   file the results are appended to (default `openers.txt`)
+    --threads      number of threads searching (default: all cores)
+*/
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../bot.hh"
+#include "../cli.hh"
+#include "../log.hh"
+#include "../work_stealing.hh"
+
+/*
+  Reads the costs of the openers done so far, then cuts off any last line
+  left incomplete, or starts the checkpoint if there is none. Returns an error
+  message if the checkpoint was started with other settings.
+*/
+std::optional<std::string> open_checkpoint(
+    std::map<std::string, double>& out_costs_by_opener,
+    std::filesystem::path checkpoint_path, const std::string& settings) {
+  std::string header = "# " + settings;
+  if (!std::filesystem::exists(checkpoint_path)) {
+    std::ofstream file(checkpoint_path);
+    file << header << std::endl;
+    return std::nullopt;
+  }
+
+  std::ifstream file(checkpoint_path);
+  std::string line;
+  if (!std::getline(file, line) || line != header) {
+    return "checkpoint " + checkpoint_path.string() +
+           " was started with other settings";
+  }
+  if (file.eof()) {
+    /* Not even the header was written whole. */
+    file.close();
+    std::ofstream(checkpoint_path) << header << std::endl;
+    return std::nullopt;
+  }
+  int64_t num_complete_bytes = header.size() + 1;
+  while (std::getline(file, line) && !file.eof()) {
+    std::istringstream fields(line);
+    std::string opener;
+    std::string cost;
+    if (fields >> opener >> cost) {
+      out_costs_by_opener[opener] = std::stod(cost);
+    }
+    num_complete_bytes += line.size() + 1;
+  }
+  file.close();
+  std::filesystem::resize_file(checkpoint_path, num_complete_bytes);
+  return std::nullopt;
+}
+
+int main(int argc, char** argv) {
+  std::map<std::string, std::string> flags = {
+      {"--bank-root", "../../bank"},
+      {"--bank", "co_wordle"},
+      {"--guesses", wordy_witch::INCLUDE_ALL_WORDS},
+      {"--cost", "flat"},
+      {"--places", "32"},
+      {"--checkpoint", "openers.txt"},
+      {"--threads",
+       std::to_string(std::max(1U, std::thread::hardware_concurrency()))},
+  };
+  std::optional<std::string> flag_error =
+      wordy_witch::parse_flags(flags, {}, argc, argv);
+  if (flag_error.has_value()) {
+    std::cerr << flag_error.value() << std::endl;
+    return 1;
+  }
+
+  static wordy_witch::word_bank bank;
+  std::filesystem::path bank_path =
+      std::filesystem::path(flags["--bank-root"]) / flags["--bank"];
+  if (!wordy_witch::read_bank(bank, bank_path, flags["--guesses"])) {
+    std::cerr << "Cannot load bank " << flags["--bank"] << std::endl;
+    return 1;
+  }
+  WORDY_WITCH_TRACE("Done bank loading", bank.num_words);
+  std::optional<wordy_witch::guess_cost_function> get_guess_cost =
+      wordy_witch::find_guess_cost_function(flags["--cost"]);
+  if (!get_guess_cost.has_value()) {
+    std::cerr << "Unknown cost " << flags["--cost"] << std::endl;
+    return 1;
+  }
+  wordy_witch::candidate_pruning_policy pruning_policy = {
+      .max_entropy_place_to_consider = std::stoi(flags["--places"]),
+  };
+
+  std::map<std::string, double> costs_by_opener;
+  std::filesystem::path checkpoint_path = flags["--checkpoint"];
+  std::optional<std::string> error = open_checkpoint(
+      costs_by_opener, checkpoint_path,
+      wordy_witch::format_opening_book_entry_key({
+          .bank_hash = bank.hash,
+          .cost_model = flags["--cost"],
+          .pruning_policy = pruning_policy,
+          .num_attempts_allowed = wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED,
+      }));
+  if (error.has_value()) {
+    std::cerr << error.value() << std::endl;
+    return 1;
+  }
+
+  static wordy_witch::word_list all_words;
+  wordy_witch::list_all_words(all_words, bank);
+  std::vector<std::pair<double, int>> openers_by_entropy;
+  for (int i = 0; i < all_words.num_words; i++) {
+    int opener = all_words.words[i];
+    if (costs_by_opener.count(bank.words[opener]) == 0) {
+      openers_by_entropy.emplace_back(
+          -wordy_witch::compute_guess_heuristic(bank, all_words, opener)
+               .entropy,
+          opener);
+    }
+  }
+  std::sort(openers_by_entropy.begin(), openers_by_entropy.end());
+  WORDY_WITCH_TRACE("Done checkpoint reading", costs_by_opener.size(),
+                    openers_by_entropy.size());
+
+  static wordy_witch::bot_cache bot_cache = {};
+  wordy_witch::read_opening_book(
+      bank, bot_cache, bank_path / wordy_witch::OPENING_BOOK_FILE_NAME);
+  std::ofstream checkpoint(checkpoint_path, std::ios::app);
+  checkpoint << std::setprecision(17);
+  std::mutex checkpoint_mutex;
+  int num_openers_left = openers_by_entropy.size();
+  auto rank_opener = [&](int opener) -> void {
+    double cost = wordy_witch::evaluate_guess(
+        bank, bot_cache, wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED, 1, all_words,
+        opener, {}, get_guess_cost.value(), pruning_policy);
+    std::lock_guard lock(checkpoint_mutex);
+    checkpoint << bank.words[opener] << "\t" << cost << std::endl;
+    costs_by_opener[bank.words[opener]] = cost;
+    num_openers_left--;
+    WORDY_WITCH_TRACE("Done opener", bank.words[opener], cost,
+                      num_openers_left);
+  };
+  wordy_witch::work_stealing_pool pool(std::stoi(flags["--threads"]));
+  wordy_witch::run_in_work_stealing_pool(pool, [&]() -> void {
+    wordy_witch::task_group tasks;
+    /* Spawned in reverse, so that this thread takes them in order. */
+    for (int i = openers_by_entropy.size() - 1; i >= 0; i--) {
+      int opener = openers_by_entropy[i].second;
+      wordy_witch::spawn_task(
+          tasks, [&rank_opener, opener]() -> void { rank_opener(opener); });
+    }
+    wordy_witch::wait_for_tasks(tasks);
+  });
+
+  std::vector<std::pair<double, std::string>> ranking;
+  for (const auto& [opener, cost] : costs_by_opener) {
+    ranking.emplace_back(cost, opener);
+  }
+  std::sort(ranking.begin(), ranking.end());
+  std::cout << std::setprecision(6);
+  std::cout << "Rank\tOpener\tCost\tEC" << std::endl;
+  for (int i = 0; i < ranking.size(); i++) {
+    const auto& [cost, opener] = ranking[i];
+    std::cout << i + 1 << "\t" << opener << "\t" << cost << "\t"
+              << cost / all_words.num_targets << std::endl;
+  }
+}
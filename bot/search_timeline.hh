@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace wordy_witch {
+
+struct search_timeline_span_record {
+  /* `find_best_guess` or `evaluate_guess` */
+  const char* name;
+  int64_t start_us;
+  int64_t duration_us;
+  int thread_index;
+  /* Number of attempts used */
+  int depth;
+  int num_words;
+  int num_targets;
+  /* -1 if no candidates were listed */
+  int num_candidates;
+  bool is_cache_hit;
+  /* Letters of the evaluated or best guess, null if there is none */
+  const char* guess;
+  double cost;
+};
+
+/*
+  Records a span for every nontrivial search node with at most `max_depth`
+  attempts used and at least `min_num_targets` targets, to be written as
+  Chrome trace events (see `write_search_timeline`). Nodes near the root are
+  few but take most of the time, so a shallow timeline costs next to nothing;
+  past `max_num_spans` spans, further ones are only counted.
+*/
+struct search_timeline {
+  int max_depth = 2;
+  int min_num_targets = 1;
+  int max_num_spans = 1 << 20;
+  std::chrono::steady_clock::time_point start_time =
+      std::chrono::steady_clock::now();
+  std::mutex mutex;
+  std::vector<search_timeline_span_record> spans;
+  int64_t num_spans_dropped = 0;
+};
+
+static int get_search_timeline_thread_index() {
+  static std::atomic<int> num_threads_seen = 0;
+  static thread_local int thread_index = num_threads_seen.fetch_add(1);
+  return thread_index;
+}
+
+/* Records its node when it goes out of scope, unless it was not selected */
+struct search_timeline_span {
+  search_timeline* timeline;
+  search_timeline_span_record record;
+
+  search_timeline_span(search_timeline* timeline, const char* name, int depth,
+                       int num_words, int num_targets, const char* guess)
+      : timeline(timeline != nullptr && depth <= timeline->max_depth &&
+                         num_targets >= timeline->min_num_targets
+                     ? timeline
+                     : nullptr) {
+    if (this->timeline == nullptr) {
+      return;
+    }
+    record = {
+        .name = name,
+        .start_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() -
+                        timeline->start_time)
+                        .count(),
+        .thread_index = get_search_timeline_thread_index(),
+        .depth = depth,
+        .num_words = num_words,
+        .num_targets = num_targets,
+        .num_candidates = -1,
+        .is_cache_hit = false,
+        .guess = guess,
+        .cost = NAN,
+    };
+  }
+  ~search_timeline_span() {
+    if (timeline == nullptr) {
+      return;
+    }
+    record.duration_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - timeline->start_time)
+            .count() -
+        record.start_us;
+    std::lock_guard lock(timeline->mutex);
+    if (timeline->spans.size() < timeline->max_num_spans) {
+      timeline->spans.push_back(record);
+    } else {
+      timeline->num_spans_dropped++;
+    }
+  }
+  search_timeline_span(const search_timeline_span&) = delete;
+  search_timeline_span& operator=(const search_timeline_span&) = delete;
+
+  void set_result(const char* guess, double cost) {
+    record.guess = guess;
+    record.cost = cost;
+  }
+  /* For a node handed over to another search, which records it instead */
+  void drop() { timeline = nullptr; }
+};
+
+/* Writes `timeline` in the Chrome trace event format, e.g. for Perfetto */
+void write_search_timeline(std::ostream& out, search_timeline& timeline) {
+  std::lock_guard lock(timeline.mutex);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  for (int i = 0; i < timeline.spans.size(); i++) {
+    const search_timeline_span_record& span = timeline.spans[i];
+    out << (i > 0 ? ",\n" : "\n") << "{\"name\":\"" << span.name
+        << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << span.thread_index
+        << ",\"ts\":" << span.start_us << ",\"dur\":" << span.duration_us
+        << ",\"args\":{\"depth\":" << span.depth
+        << ",\"words\":" << span.num_words
+        << ",\"targets\":" << span.num_targets;
+    if (span.num_candidates >= 0) {
+      out << ",\"candidates\":" << span.num_candidates;
+    }
+    out << ",\"cache_hit\":" << (span.is_cache_hit ? "true" : "false");
+    if (span.guess != nullptr) {
+      out << ",\"guess\":\"" << span.guess << "\"";
+    }
+    if (std::isfinite(span.cost)) {
+      out << ",\"cost\":" << span.cost;
+    } else if (!std::isnan(span.cost)) {
+      out << ",\"cost\":\"inf\"";
+    }
+    out << "}}";
+  }
+  out << "\n],\"otherData\":{\"spans_dropped\":" << timeline.num_spans_dropped
+      << "}}\n";
+}
+
+}  // namespace wordy_witch
@@ -0,0 +1,502 @@
+/*
+  Keeps banks and the bot cache resident and answers line-delimited queries,
+  read from standard input (the default) or from clients of a Unix socket
+  (`--socket PATH`). Queries are solved concurrently by `--threads` workers.
+  Banks listed by `--shared-banks` (comma-separated, e.g.
+  `co_wordle,co_wordle_unlimited`) share the verdicts of one root bank,
+  holding their words with up to `--shared-guesses` guesses (default
+  `common`), instead of a precompute each. Board states are resolved through
+  an index of each bank (see `board_index.hh`).
+
+  Each query is a line of whitespace-separated `key=value` fields:
+    id        echoed at the start of every response line
+    bank      a bank directory under `--bank-root` (default `../../bank`)
+    guesses   `targets`, `common` (default) or `all`
+    cost      `flat` (default) or `penalty`
+    places    `max_entropy_place_to_consider` (default 32)
+    initial_places
+              `max_entropy_place_to_consider_for_initial_attempt`
+    state     comma-separated guesses and verdicts, e.g. `LEAST,-^--#`
+  For a state ending with a verdict (or an empty state), one `candidate` line
+  is streamed per candidate best guess, followed by a final `best` line. For a
+  state ending with a guess, one `verdict` line is streamed per verdict group,
+  followed by a final `evaluation` line. A bad query gets an `error` line.
+*/
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <csignal>
+#include <deque>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../board_index.hh"
+#include "../bot.hh"
+#include "../cli.hh"
+#include "../log.hh"
+
+struct connection {
+  int fd;
+  std::mutex mutex;
+
+  ~connection() {
+    if (fd != STDOUT_FILENO) {
+      close(fd);
+    }
+  }
+
+  void send_line(const std::string& line) {
+    std::string data = line + "\n";
+    std::lock_guard lock(mutex);
+    for (size_t num_bytes_sent = 0; num_bytes_sent < data.size();) {
+      ssize_t n = fd == STDOUT_FILENO
+                      ? write(fd, data.data() + num_bytes_sent,
+                              data.size() - num_bytes_sent)
+                      : send(fd, data.data() + num_bytes_sent,
+                             data.size() - num_bytes_sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+        return;
+      }
+      num_bytes_sent += n;
+    }
+  }
+};
+
+struct query_job {
+  std::shared_ptr<connection> client;
+  std::string line;
+};
+
+class query_queue {
+ public:
+  void push(query_job job) {
+    {
+      std::lock_guard lock(mutex_);
+      jobs_.push_back(std::move(job));
+    }
+    has_jobs_or_closed_.notify_one();
+  }
+
+  void close() {
+    {
+      std::lock_guard lock(mutex_);
+      closed_ = true;
+    }
+    has_jobs_or_closed_.notify_all();
+  }
+
+  std::optional<query_job> pop() {
+    std::unique_lock lock(mutex_);
+    has_jobs_or_closed_.wait(lock,
+                             [this]() { return closed_ || !jobs_.empty(); });
+    if (jobs_.empty()) {
+      return std::nullopt;
+    }
+    query_job job = std::move(jobs_.front());
+    jobs_.pop_front();
+    return job;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable has_jobs_or_closed_;
+  std::deque<query_job> jobs_;
+  bool closed_ = false;
+};
+
+using board_index =
+    wordy_witch::basic_board_index<wordy_witch::word_bank_view>;
+
+/*
+  Every bank is served as a view of a root bank. Banks named by `share` are
+  views of a single root bank, loaded once; any other bank gets a root bank
+  of its own on first use.
+*/
+class bank_registry {
+ public:
+  bank_registry(std::filesystem::path root, wordy_witch::bot_cache& cache)
+      : root_(root), cache_(cache) {}
+
+  /*
+    Loads a root bank holding the words of `names` with up to
+    `guesses_inclusion` guesses, which their views then read from; returns
+    false if it cannot be loaded
+  */
+  bool share(const std::vector<std::string>& names,
+             const std::string& guesses_inclusion) {
+    WORDY_WITCH_TRACE("Loading shared bank", names.size(), guesses_inclusion);
+    std::vector<std::filesystem::path> dict_paths;
+    for (const std::string& name : names) {
+      dict_paths.push_back(root_ / name);
+    }
+    shared_root_bank_ =
+        std::make_unique_for_overwrite<wordy_witch::word_bank>();
+    if (!wordy_witch::read_union_bank(*shared_root_bank_, dict_paths,
+                                      guesses_inclusion)) {
+      shared_root_bank_.reset();
+      return false;
+    }
+    shared_names_ = names;
+    shared_guesses_inclusion_ = guesses_inclusion;
+    WORDY_WITCH_TRACE("Done shared bank loading",
+                      shared_root_bank_->num_words);
+    return true;
+  }
+
+  /*
+    Loads the bank, along with its opening book and board index, on first use;
+    returns nullptr if it cannot be loaded.
+  */
+  const board_index* get(const std::string& name,
+                         const std::string& guesses_inclusion) {
+    entry* e;
+    {
+      std::lock_guard lock(mutex_);
+      std::unique_ptr<entry>& slot = entries_[name + "/" + guesses_inclusion];
+      if (!slot) {
+        slot = std::make_unique<entry>();
+      }
+      e = slot.get();
+    }
+    std::call_once(e->loaded, [this, e, &name, &guesses_inclusion]() -> void {
+      WORDY_WITCH_TRACE("Loading bank", name, guesses_inclusion);
+      const wordy_witch::word_bank* root_bank = shared_root_bank_.get();
+      if (!is_shared(name, guesses_inclusion)) {
+        e->root_bank = std::make_unique_for_overwrite<wordy_witch::word_bank>();
+        if (!wordy_witch::read_bank(*e->root_bank, root_ / name,
+                                    guesses_inclusion)) {
+          e->root_bank.reset();
+          return;
+        }
+        root_bank = e->root_bank.get();
+      }
+      e->bank = std::make_unique<wordy_witch::word_bank_view>(*root_bank);
+      if (!wordy_witch::read_bank_view(*e->bank, root_ / name,
+                                       guesses_inclusion)) {
+        e->bank.reset();
+        return;
+      }
+      int num_opening_book_entries = wordy_witch::read_opening_book(
+          *e->bank, cache_,
+          root_ / name / wordy_witch::OPENING_BOOK_FILE_NAME);
+      e->index = std::make_unique<board_index>();
+      wordy_witch::build_board_index(*e->index, *e->bank);
+      WORDY_WITCH_TRACE("Done bank loading", name, guesses_inclusion,
+                        num_opening_book_entries, e->index->postings.size());
+    });
+    return e->index.get();
+  }
+
+ private:
+  struct entry {
+    std::once_flag loaded;
+    /* Null if the bank is a view of the shared root bank */
+    std::unique_ptr<wordy_witch::word_bank> root_bank;
+    std::unique_ptr<wordy_witch::word_bank_view> bank;
+    /* Null if the bank cannot be loaded */
+    std::unique_ptr<board_index> index;
+  };
+
+  bool is_shared(const std::string& name,
+                 const std::string& guesses_inclusion) const {
+    const std::vector<std::string> inclusions = {
+        wordy_witch::INCLUDE_TARGETS_ONLY,
+        wordy_witch::INCLUDE_COMMON_WORDS_ONLY,
+        wordy_witch::INCLUDE_ALL_WORDS,
+    };
+    auto find_inclusion = [&inclusions](const std::string& inclusion) -> int {
+      return std::find(inclusions.begin(), inclusions.end(), inclusion) -
+             inclusions.begin();
+    };
+    return shared_root_bank_ &&
+           std::find(shared_names_.begin(), shared_names_.end(), name) !=
+               shared_names_.end() &&
+           find_inclusion(guesses_inclusion) <=
+               find_inclusion(shared_guesses_inclusion_);
+  }
+
+  std::filesystem::path root_;
+  wordy_witch::bot_cache& cache_;
+  std::unique_ptr<wordy_witch::word_bank> shared_root_bank_;
+  std::vector<std::string> shared_names_;
+  std::string shared_guesses_inclusion_;
+  std::mutex mutex_;
+  std::map<std::string, std::unique_ptr<entry>> entries_;
+};
+
+struct query {
+  std::string id;
+  std::string bank_name;
+  std::string guesses_inclusion = wordy_witch::INCLUDE_COMMON_WORDS_ONLY;
+  std::string cost_model = "flat";
+  wordy_witch::candidate_pruning_policy pruning_policy =
+      wordy_witch::default_candidate_pruning_policy;
+  std::vector<std::string> state;
+};
+
+static std::optional<std::string> parse_query(query& out_query,
+                                              const std::string& line) {
+  auto parse_positive_int = [](const std::string& text) -> std::optional<int> {
+    if (text.empty() || text.size() > 6 ||
+        !std::all_of(text.begin(), text.end(), ::isdigit) ||
+        std::stoi(text) < 1) {
+      return std::nullopt;
+    }
+    return std::stoi(text);
+  };
+
+  std::istringstream fields(line);
+  for (std::string field; fields >> field;) {
+    size_t separator = field.find('=');
+    if (separator == std::string::npos) {
+      return "malformed field " + field;
+    }
+    std::string key = field.substr(0, separator);
+    std::string value = field.substr(separator + 1);
+    if (key == "id") {
+      out_query.id = value;
+    } else if (key == "bank") {
+      if (value.empty() || value.find_first_not_of(
+                               "abcdefghijklmnopqrstuvwxyz0123456789_") !=
+                               std::string::npos) {
+        return "invalid bank " + value;
+      }
+      out_query.bank_name = value;
+    } else if (key == "guesses") {
+      if (value != wordy_witch::INCLUDE_TARGETS_ONLY &&
+          value != wordy_witch::INCLUDE_COMMON_WORDS_ONLY &&
+          value != wordy_witch::INCLUDE_ALL_WORDS) {
+        return "invalid guesses " + value;
+      }
+      out_query.guesses_inclusion = value;
+    } else if (key == "cost") {
+      out_query.cost_model = value;
+    } else if (key == "places" || key == "initial_places") {
+      std::optional<int> place = parse_positive_int(value);
+      if (!place.has_value()) {
+        return "invalid " + key + " " + value;
+      }
+      if (key == "places") {
+        out_query.pruning_policy.max_entropy_place_to_consider = place.value();
+      } else {
+        out_query.pruning_policy
+            .max_entropy_place_to_consider_for_initial_attempt = place.value();
+      }
+    } else if (key == "state") {
+      std::istringstream words(value);
+      for (std::string word; std::getline(words, word, ',');) {
+        out_query.state.push_back(word);
+      }
+    } else {
+      return "unknown field " + key;
+    }
+  }
+  if (out_query.bank_name.empty()) {
+    return "missing bank";
+  }
+  if (out_query.state.size() / 2 + 1 >=
+      wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED) {
+    return "too many attempts in state";
+  }
+  return std::nullopt;
+}
+
+static void answer_query(bank_registry& banks, wordy_witch::bot_cache& cache,
+                         connection& client, const std::string& line) {
+  query q;
+  std::optional<std::string> error = parse_query(q, line);
+  auto format = [&q](auto... fields) -> std::string {
+    std::ostringstream out;
+    out << std::setprecision(10) << q.id;
+    ((out << "\t" << fields), ...);
+    return out.str();
+  };
+  if (error.has_value()) {
+    client.send_line(format("error", error.value()));
+    return;
+  }
+  std::optional<wordy_witch::guess_cost_function> get_guess_cost =
+      wordy_witch::find_guess_cost_function(q.cost_model);
+  if (!get_guess_cost.has_value()) {
+    client.send_line(format("error", "unknown cost " + q.cost_model));
+    return;
+  }
+  const board_index* index = banks.get(q.bank_name, q.guesses_inclusion);
+  if (index == nullptr) {
+    client.send_line(format("error", "cannot load bank " + q.bank_name));
+    return;
+  }
+  const wordy_witch::word_bank_view* bank = index->bank;
+
+  static thread_local std::unique_ptr<wordy_witch::word_list>
+      preallocated_remaining_words =
+          std::make_unique_for_overwrite<wordy_witch::word_list>();
+  wordy_witch::word_list& remaining_words = *preallocated_remaining_words;
+  error = wordy_witch::resolve_board_state(remaining_words, *index, q.state);
+  if (error.has_value()) {
+    client.send_line(format("error", error.value()));
+    return;
+  }
+
+  if (q.state.size() % 2 == 0) {
+    int num_attempts_used = q.state.size() / 2;
+    wordy_witch::candidate_info best_guess = wordy_witch::find_best_guess(
+        *bank, cache, wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED, num_attempts_used,
+        remaining_words,
+        [&client, &format,
+         bank](wordy_witch::candidate_info candidate) -> void {
+          client.send_line(format("candidate", bank->words[candidate.guess],
+                                  candidate.cost));
+        },
+        get_guess_cost.value(), q.pruning_policy);
+    client.send_line(format("best", bank->words[best_guess.guess],
+                            best_guess.cost,
+                            best_guess.cost / remaining_words.num_targets,
+                            remaining_words.num_words,
+                            remaining_words.num_targets));
+    return;
+  }
+
+  int num_attempts_used = q.state.size() / 2 + 1;
+  int guess = wordy_witch::find_indexed_word(*index, q.state.back()).value();
+  double cost = wordy_witch::evaluate_guess(
+      *bank, cache, wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED, num_attempts_used,
+      remaining_words, guess,
+      [&client, &format, bank](int verdict,
+                               wordy_witch::word_list_view verdict_group,
+                               wordy_witch::candidate_info best_guess) -> void {
+        client.send_line(format(
+            "verdict", verdict, wordy_witch::format_verdict(verdict),
+            bank->words[best_guess.guess], verdict_group.num_words,
+            verdict_group.num_targets, best_guess.cost));
+      },
+      get_guess_cost.value(), q.pruning_policy);
+  client.send_line(format("evaluation", bank->words[guess], cost,
+                          cost / remaining_words.num_targets,
+                          remaining_words.num_words,
+                          remaining_words.num_targets));
+}
+
+static void read_queries(query_queue& queue,
+                         const std::shared_ptr<connection>& client,
+                         int input_fd) {
+  std::string pending;
+  char buffer[4096];
+  for (ssize_t n; (n = read(input_fd, buffer, sizeof(buffer))) > 0;) {
+    pending.append(buffer, n);
+    for (size_t end; (end = pending.find('\n')) != std::string::npos;) {
+      std::string line = pending.substr(0, end);
+      pending.erase(0, end + 1);
+      if (line.find_first_not_of(" \t\r") != std::string::npos) {
+        queue.push({.client = client, .line = line});
+      }
+    }
+  }
+  if (pending.find_first_not_of(" \t\r") != std::string::npos) {
+    queue.push({.client = client, .line = pending});
+  }
+}
+
+int main(int argc, char** argv) {
+  std::map<std::string, std::string> flags = {
+      {"--bank-root", "../../bank"},
+      {"--threads",
+       std::to_string(std::max(1U, std::thread::hardware_concurrency()))},
+      {"--shared-banks", ""},
+      {"--shared-guesses", wordy_witch::INCLUDE_COMMON_WORDS_ONLY},
+  };
+  std::optional<std::string> flag_error =
+      wordy_witch::parse_flags(flags, {"--socket"}, argc, argv);
+  if (flag_error.has_value()) {
+    std::cerr << flag_error.value() << std::endl;
+    return 1;
+  }
+  std::filesystem::path bank_root = flags["--bank-root"];
+  int num_threads = 0;
+  std::istringstream threads(flags["--threads"]);
+  if (!(threads >> num_threads) || !threads.eof() || num_threads < 1) {
+    std::cerr << "Invalid threads " << flags["--threads"] << std::endl;
+    return 1;
+  }
+  std::optional<std::string> socket_path;
+  if (flags.count("--socket") > 0) {
+    socket_path = flags["--socket"];
+  }
+  std::vector<std::string> shared_bank_names;
+  std::istringstream names(flags["--shared-banks"]);
+  for (std::string name; std::getline(names, name, ',');) {
+    shared_bank_names.push_back(name);
+  }
+  std::string shared_guesses_inclusion = flags["--shared-guesses"];
+  if (shared_guesses_inclusion != wordy_witch::INCLUDE_TARGETS_ONLY &&
+      shared_guesses_inclusion != wordy_witch::INCLUDE_COMMON_WORDS_ONLY &&
+      shared_guesses_inclusion != wordy_witch::INCLUDE_ALL_WORDS) {
+    std::cerr << "Unknown guesses " << shared_guesses_inclusion << std::endl;
+    return 1;
+  }
+  std::signal(SIGPIPE, SIG_IGN);
+
+  static wordy_witch::bot_cache bot_cache = {};
+  static bank_registry banks(bank_root, bot_cache);
+  if (!shared_bank_names.empty() &&
+      !banks.share(shared_bank_names, shared_guesses_inclusion)) {
+    std::cerr << "Cannot load shared banks" << std::endl;
+    return 1;
+  }
+  static query_queue queue;
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < num_threads; i++) {
+    workers.emplace_back([]() -> void {
+      while (std::optional<query_job> job = queue.pop()) {
+        answer_query(banks, bot_cache, *job->client, job->line);
+      }
+    });
+  }
+
+  if (!socket_path.has_value()) {
+    read_queries(queue, std::make_shared<connection>(STDOUT_FILENO),
+                 STDIN_FILENO);
+    queue.close();
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+    return 0;
+  }
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address = {.sun_family = AF_UNIX};
+  if (socket_path->size() >= sizeof(address.sun_path)) {
+    std::cerr << "Socket path is too long" << std::endl;
+    return 1;
+  }
+  std::copy(socket_path->begin(), socket_path->end(), address.sun_path);
+  unlink(socket_path->c_str());
+  if (listener < 0 ||
+      bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) <
+          0 ||
+      listen(listener, SOMAXCONN) < 0) {
+    std::cerr << "Cannot listen on " << socket_path.value() << std::endl;
+    return 1;
+  }
+  WORDY_WITCH_TRACE("Listening", socket_path.value());
+  for (int client_fd; (client_fd = accept(listener, nullptr, nullptr)) >= 0;) {
+    std::thread([client_fd]() -> void {
+      read_queries(queue, std::make_shared<connection>(client_fd), client_fd);
+    }).detach();
+  }
+  return 0;
+}
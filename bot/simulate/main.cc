@@ -0,0 +1,214 @@
+/*
+  Plays every target of a bank through a strategy and reports the mean number
+  of attempts, the attempt distribution, the failures and the throughput.
+
+  Flags (each followed by a value):
+    --bank-root    directory holding the banks (default `../../bank`)
+    --bank         bank the strategy is built for (default
+                   `co_wordle_unlimited`)
+    --guesses      `targets`, `common` (default) or `all`
+    --targets      bank whose targets are played (default: `--bank`)
+    --policy       `strategy` (default) to build one strategy up front and
+                   replay it, or `live` to call `find_best_guess` every turn
+    --opener       forced first guess of the strategy
+    --cost         `flat` (default) or `penalty`
+    --places       `max_entropy_place_to_consider` (default 32)
+    --estimate-targets
+                   `min_num_targets_to_estimate`: nodes with at least this
+                   many targets evaluate only the candidates with the best
+                   Monte Carlo estimates (default: never)
+    --threads      number of games played in parallel
+    --traces       `1` to print the guesses and verdicts of every game
+    --timeline     file to write the search nodes to, as Chrome trace events
+    --timeline-depth
+                   deepest attempt whose search nodes are written (default 2)
+*/
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../bot.hh"
+#include "../cli.hh"
+#include "../log.hh"
+#include "../search_timeline.hh"
+#include "../simulation.hh"
+
+int main(int argc, char** argv) {
+  std::map<std::string, std::string> flags = {
+      {"--bank-root", "../../bank"},
+      {"--bank", "co_wordle_unlimited"},
+      {"--guesses", wordy_witch::INCLUDE_COMMON_WORDS_ONLY},
+      {"--policy", "strategy"},
+      {"--cost", "flat"},
+      {"--places", "32"},
+      {"--threads",
+       std::to_string(std::max(1U, std::thread::hardware_concurrency()))},
+      {"--traces", "0"},
+      {"--timeline-depth", "2"},
+  };
+  std::optional<std::string> flag_error = wordy_witch::parse_flags(
+      flags, {"--targets", "--opener", "--estimate-targets", "--timeline"},
+      argc, argv);
+  if (flag_error.has_value()) {
+    std::cerr << flag_error.value() << std::endl;
+    return 1;
+  }
+  if (flags.count("--targets") == 0) {
+    flags["--targets"] = flags["--bank"];
+  }
+  if (flags["--policy"] != "strategy" && flags["--policy"] != "live") {
+    std::cerr << "Unknown policy " << flags["--policy"] << std::endl;
+    return 1;
+  }
+
+  static wordy_witch::word_bank bank;
+  std::filesystem::path bank_root = flags["--bank-root"];
+  if (!wordy_witch::read_bank(bank, bank_root / flags["--bank"],
+                              flags["--guesses"])) {
+    std::cerr << "Cannot load bank " << flags["--bank"] << std::endl;
+    return 1;
+  }
+  std::vector<std::string> targets;
+  wordy_witch::read_words(targets,
+                          bank_root / flags["--targets"] / "targets.txt");
+  for (std::string& target : targets) {
+    target = wordy_witch::to_upper(target);
+  }
+  std::erase_if(targets, [](const std::string& target) -> bool {
+    return target.size() != wordy_witch::WORD_SIZE;
+  });
+  WORDY_WITCH_TRACE("Done bank loading", bank.num_words, targets.size());
+
+  std::optional<wordy_witch::guess_cost_function> get_guess_cost =
+      wordy_witch::find_guess_cost_function(flags["--cost"]);
+  if (!get_guess_cost.has_value()) {
+    std::cerr << "Unknown cost " << flags["--cost"] << std::endl;
+    return 1;
+  }
+  wordy_witch::candidate_pruning_policy pruning_policy = {
+      .max_entropy_place_to_consider = std::stoi(flags["--places"]),
+  };
+  if (flags.count("--estimate-targets") > 0) {
+    pruning_policy.min_num_targets_to_estimate =
+        std::stoi(flags["--estimate-targets"]);
+  }
+  std::optional<int> opener;
+  if (flags.count("--opener") > 0) {
+    opener =
+        wordy_witch::find_word(bank, wordy_witch::to_upper(flags["--opener"]));
+    if (!opener.has_value()) {
+      std::cerr << "Unknown opener " << flags["--opener"] << std::endl;
+      return 1;
+    }
+  }
+
+  static wordy_witch::word_list all_words;
+  wordy_witch::list_all_words(all_words, bank);
+  static wordy_witch::bot_cache bot_cache = {};
+  wordy_witch::read_opening_book(
+      bank, bot_cache,
+      bank_root / flags["--bank"] / wordy_witch::OPENING_BOOK_FILE_NAME);
+  int num_threads = std::max(1, std::stoi(flags["--threads"]));
+  static wordy_witch::search_timeline timeline;
+  if (flags.count("--timeline") > 0) {
+    timeline.max_depth = std::stoi(flags["--timeline-depth"]);
+    bot_cache.timeline = &timeline;
+  }
+
+  wordy_witch::simulation_report report;
+  if (flags["--policy"] == "live") {
+    if (opener.has_value()) {
+      std::cerr << "--opener only applies to --policy strategy" << std::endl;
+      return 1;
+    }
+    report = wordy_witch::simulate_games(
+        targets,
+        [&get_guess_cost, &pruning_policy](
+            const std::string& target) -> wordy_witch::game_trace {
+          return wordy_witch::simulate_game_with_find_best_guess(
+              bank, bot_cache, wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED, 0,
+              all_words, target, get_guess_cost.value(), pruning_policy);
+        },
+        num_threads);
+  } else {
+    std::optional<wordy_witch::strategy> strategy =
+        wordy_witch::find_best_strategy(
+            bank, bot_cache, wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED, 0,
+            all_words, opener, get_guess_cost.value(), pruning_policy);
+    if (!strategy.has_value()) {
+      std::cerr << "No strategy wins every game of " << flags["--bank"]
+                << std::endl;
+      return 1;
+    }
+    WORDY_WITCH_TRACE("Done strategy building",
+                      bank.words[strategy.value().guess]);
+    report = wordy_witch::simulate_games(
+        targets,
+        [&strategy](const std::string& target) -> wordy_witch::game_trace {
+          return wordy_witch::simulate_game_with_strategy(
+              bank, strategy.value(), wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED, 0,
+              target);
+        },
+        num_threads);
+  }
+
+  if (bot_cache.timeline != nullptr) {
+    std::ofstream timeline_file(flags["--timeline"]);
+    wordy_witch::write_search_timeline(timeline_file, timeline);
+    WORDY_WITCH_TRACE("Done timeline writing", timeline.spans.size(),
+                      timeline.num_spans_dropped);
+  }
+
+  std::cout << std::setprecision(4);
+  if (flags["--traces"] == "1") {
+    std::cout << "Target\tSolved\tAttempts\tGuesses" << std::endl;
+    for (const wordy_witch::game_trace& trace : report.traces) {
+      std::cout << trace.target << "\t" << trace.solved << "\t"
+                << trace.guesses.size();
+      for (int i = 0; i < trace.guesses.size(); i++) {
+        std::cout << "\t" << bank.words[trace.guesses[i]] << " "
+                  << wordy_witch::format_verdict(trace.verdicts[i]);
+      }
+      std::cout << std::endl;
+    }
+    std::cout << std::endl;
+  }
+
+  std::cout << "Played " << report.num_games << " games of "
+            << flags["--targets"] << " against a " << flags["--policy"]
+            << " policy for " << flags["--bank"] << " in "
+            << report.seconds_elapsed << "s ("
+            << report.num_games / report.seconds_elapsed << " games/s)"
+            << std::endl;
+  std::cout << "Solved " << report.num_games_solved << " games with a mean of ";
+  if (report.num_games_solved > 0) {
+    std::cout << report.total_num_attempts_used * 1.0 / report.num_games_solved;
+  } else {
+    std::cout << "n/a";
+  }
+  std::cout << " attempts" << std::endl;
+  std::cout << "Attempt distribution:" << std::endl;
+  for (int i = 0; i < wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED; i++) {
+    if (i > 0) {
+      std::cout << "\t";
+    }
+    std::cout << report.num_targets_solved_by_attempts_used[i];
+  }
+  std::cout << std::endl;
+  std::cout << "Failures:";
+  for (const wordy_witch::game_trace& trace : report.traces) {
+    if (!trace.solved) {
+      std::cout << " " << trace.target;
+    }
+  }
+  std::cout << std::endl;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bot.hh"
+
+namespace wordy_witch {
+
+struct game_trace {
+  std::string target;
+  std::vector<int> guesses;
+  std::vector<int> verdicts;
+  bool solved;
+  /* Including the attempts used before the simulation started */
+  int num_attempts_used;
+};
+
+/*
+  Plays one game against `target` (which may lie outside of the bank) by
+  following `root_strategy`; the game is lost when the strategy has no
+  follow-up for some verdict or runs out of attempts
+*/
+template <typename bank_type>
+game_trace simulate_game_with_strategy(const bank_type& bank,
+                                       const strategy& root_strategy,
+                                       int num_attempts_allowed,
+                                       int num_attempts_used,
+                                       const std::string& target) {
+  game_trace trace = {.target = target};
+  const strategy* node = &root_strategy;
+  for (int attempt = num_attempts_used; attempt < num_attempts_allowed;
+       attempt++) {
+    int verdict =
+        judge<bank_type::WORD_SIZE>(bank.words[node->guess], target.c_str());
+    trace.guesses.push_back(node->guess);
+    trace.verdicts.push_back(verdict);
+    if (verdict == bank_type::ALL_GREEN_VERDICT) {
+      trace.solved = true;
+      trace.num_attempts_used = attempt + 1;
+      return trace;
+    }
+    auto it = node->follow_ups_by_verdict.find(verdict);
+    if (it == node->follow_ups_by_verdict.end() || !it->second.has_value()) {
+      break;
+    }
+    node = &it->second.value();
+  }
+  return trace;
+}
+
+/*
+  Plays one game against `target` by calling `find_best_guess` on the
+  remaining words before every attempt, starting from `remaining_words`
+*/
+template <typename bank_type>
+game_trace simulate_game_with_find_best_guess(
+    const bank_type& bank, bot_cache& cache, int num_attempts_allowed,
+    int num_attempts_used, const word_list& remaining_words,
+    const std::string& target,
+    guess_cost_function get_guess_cost = get_flat_guess_cost,
+    candidate_pruning_policy pruning_policy =
+        default_candidate_pruning_policy) {
+  static thread_local std::unique_ptr<word_list> preallocated_remaining_words =
+      std::make_unique_for_overwrite<word_list>();
+  word_list& current_words = *preallocated_remaining_words;
+  current_words = remaining_words;
+
+  game_trace trace = {.target = target};
+  for (int attempt = num_attempts_used; attempt < num_attempts_allowed;
+       attempt++) {
+    int guess = find_best_guess(bank, cache, num_attempts_allowed, attempt,
+                                current_words, {}, get_guess_cost,
+                                pruning_policy)
+                    .guess;
+    int verdict =
+        judge<bank_type::WORD_SIZE>(bank.words[guess], target.c_str());
+    trace.guesses.push_back(guess);
+    trace.verdicts.push_back(verdict);
+    if (verdict == bank_type::ALL_GREEN_VERDICT) {
+      trace.solved = true;
+      trace.num_attempts_used = attempt + 1;
+      return trace;
+    }
+    apply_verdict(current_words, bank, guess, verdict);
+    if (current_words.num_targets == 0) {
+      /* The target is not one of the targets the policy plays for. */
+      break;
+    }
+  }
+  return trace;
+}
+
+struct simulation_report {
+  std::vector<game_trace> traces;
+  int num_games;
+  int num_games_solved;
+  int total_num_attempts_used;
+  int num_targets_solved_by_attempts_used[MAX_NUM_ATTEMPTS_ALLOWED];
+  double seconds_elapsed;
+};
+
+using simulate_game_function =
+    std::function<game_trace(const std::string& target)>;
+
+/*
+  Plays every target with `simulate_game` on `num_threads` threads; traces are
+  reported in the order of `targets`. `simulate_game` must be safe to call
+  concurrently, which holds for both simulators above.
+*/
+simulation_report simulate_games(const std::vector<std::string>& targets,
+                                 simulate_game_function simulate_game,
+                                 int num_threads) {
+  auto start_time = std::chrono::steady_clock::now();
+  simulation_report report = {
+      .traces = std::vector<game_trace>(targets.size()),
+      .num_games = static_cast<int>(targets.size()),
+  };
+  std::atomic<int> next_target_index = 0;
+  auto play_remaining_games = [&targets, &simulate_game, &report,
+                               &next_target_index]() -> void {
+    for (int i; (i = next_target_index++) < targets.size();) {
+      report.traces[i] = simulate_game(targets[i]);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < num_threads; i++) {
+    workers.emplace_back(play_remaining_games);
+  }
+  play_remaining_games();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  for (const game_trace& trace : report.traces) {
+    if (!trace.solved) {
+      continue;
+    }
+    report.num_games_solved++;
+    report.total_num_attempts_used += trace.num_attempts_used;
+    report.num_targets_solved_by_attempts_used[trace.num_attempts_used - 1]++;
+  }
+  report.seconds_elapsed = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start_time)
+                               .count();
+  return report;
+}
+
+}  // namespace wordy_witch
@@ -0,0 +1,202 @@
+/*
+  Checks the engine at the word sizes no bank ships with. For each of 4, 6
+  and 7 letters, it makes words of that size out of the words of a 5-letter
+  bank (cut short, or padded with their own first letters), loads them into a
+  bank of that size, and checks:
+    - that a bank of that size rejects the 5-letter words;
+    - every precomputed verdict against a plain reimplementation of the rules,
+      and that verdicts read back as they are written;
+    - the verdict groups of a few guesses, targets and hard mode guesses
+      alike;
+    - that the best strategy for the whole bank wins every game.
+  Prints one line per word size and exits with 1 if any check fails.
+
+  Flags (each followed by a value):
+    --bank-root    directory holding the banks (default `../../bank`)
+    --bank         5-letter bank the words are made from (default `co_wordle`)
+    --words        number of targets, and of other guesses, taken from it
+                   (default 100)
+*/
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../bot.hh"
+#include "../cli.hh"
+
+/* Scores `guess` as a player would, tile by tile */
+int judge_by_hand(const std::string& guess, const std::string& target) {
+  std::vector<int> tiles(guess.size(), wordy_witch::VERDICT_VALUE_BLACK);
+  std::multiset<char> letters_left;
+  for (int i = 0; i < guess.size(); i++) {
+    if (guess[i] == target[i]) {
+      tiles[i] = wordy_witch::VERDICT_VALUE_GREEN;
+    } else {
+      letters_left.insert(target[i]);
+    }
+  }
+  for (int i = 0; i < guess.size(); i++) {
+    auto it = letters_left.find(guess[i]);
+    if (tiles[i] != wordy_witch::VERDICT_VALUE_GREEN &&
+        it != letters_left.end()) {
+      tiles[i] = wordy_witch::VERDICT_VALUE_YELLOW;
+      letters_left.erase(it);
+    }
+  }
+  int verdict = 0;
+  for (int tile : tiles) {
+    verdict = verdict * 3 + tile;
+  }
+  return verdict;
+}
+
+/*
+  Returns an error message if some check fails at this word size (see the top
+  of this file)
+*/
+template <int word_size>
+std::optional<std::string> check_word_size(
+    const std::vector<std::string>& five_letter_words, int num_targets) {
+  using bank_type = wordy_witch::basic_word_bank<word_size>;
+  static bank_type bank;
+  if (wordy_witch::load_bank(bank, five_letter_words, num_targets)) {
+    return "5-letter words were loaded";
+  }
+
+  std::vector<std::string> words;
+  std::unordered_set<std::string> words_seen;
+  int num_bank_targets = 0;
+  for (int i = 0; i < five_letter_words.size(); i++) {
+    std::string word = five_letter_words[i];
+    while (word.size() < word_size) {
+      word += word[word.size() - wordy_witch::WORD_SIZE];
+    }
+    word.resize(word_size);
+    if (words_seen.insert(word).second) {
+      words.push_back(word);
+      num_bank_targets += i < num_targets;
+    }
+  }
+  if (!wordy_witch::load_bank(bank, words, num_bank_targets)) {
+    return "the words were not loaded";
+  }
+
+  for (int i = 0; i < bank.num_words; i++) {
+    for (int j = 0; j < bank.num_words; j++) {
+      int verdict = bank.verdicts[i][j];
+      if (verdict != judge_by_hand(bank.words[i], bank.words[j])) {
+        return "wrong verdict for " + std::string(bank.words[i]) + " against " +
+               bank.words[j];
+      }
+      if (wordy_witch::parse_verdict<word_size>(
+              wordy_witch::format_verdict<word_size>(verdict)) != verdict) {
+        return "verdict " + std::to_string(verdict) + " does not read back";
+      }
+    }
+  }
+
+  static wordy_witch::verdict_groups_for<bank_type> groups;
+  const wordy_witch::word_list& all_words = bank.all_words;
+  for (int guess = 0; guess < bank.num_words; guess += bank.num_words / 8) {
+    wordy_witch::group_remaining_words(groups, bank, all_words, guess);
+    for (int verdict = 0; verdict < bank_type::NUM_VERDICTS; verdict++) {
+      wordy_witch::word_list_view group = groups[verdict];
+      std::set<int> expected_words;
+      int num_expected_targets = 0;
+      for (int i = 0; i < all_words.num_targets; i++) {
+        int target = all_words.words[i];
+        if (bank.verdicts[guess][target] == verdict) {
+          expected_words.insert(target);
+          num_expected_targets++;
+        }
+      }
+      /* Groups without targets are left empty. */
+      for (int i = 0; i < all_words.num_words && num_expected_targets > 0;
+           i++) {
+        int word = all_words.words[i];
+        if (wordy_witch::check_is_hard_mode_valid<word_size>(
+                bank.words[guess], verdict, bank.words[word])) {
+          expected_words.insert(word);
+        }
+      }
+      if (group.num_targets != num_expected_targets ||
+          std::set<int>(group.words, group.words + group.num_words) !=
+              expected_words) {
+        return "wrong group " +
+               wordy_witch::format_verdict<word_size>(verdict) + " for " +
+               bank.words[guess];
+      }
+    }
+  }
+
+  static wordy_witch::bot_cache bot_cache = {};
+  std::optional<wordy_witch::strategy> strategy =
+      wordy_witch::find_best_strategy(bank, bot_cache,
+                                      wordy_witch::MAX_NUM_ATTEMPTS_ALLOWED, 0,
+                                      all_words);
+  if (!strategy.has_value() ||
+      strategy.value().num_remaining_targets != all_words.num_targets) {
+    return "no strategy wins every game";
+  }
+  std::cout << word_size << " letters: " << bank.num_words << " words, "
+            << bank.num_targets << " targets, best opener "
+            << bank.words[strategy.value().guess] << " for a mean of "
+            << strategy.value().total_num_attempts_used * 1.0 /
+                   all_words.num_targets
+            << " attempts" << std::endl;
+  return std::nullopt;
+}
+
+int main(int argc, char** argv) {
+  std::map<std::string, std::string> flags = {
+      {"--bank-root", "../../bank"},
+      {"--bank", "co_wordle"},
+      {"--words", "100"},
+  };
+  std::optional<std::string> flag_error =
+      wordy_witch::parse_flags(flags, {}, argc, argv);
+  if (flag_error.has_value()) {
+    std::cerr << flag_error.value() << std::endl;
+    return 1;
+  }
+
+  std::filesystem::path bank_path =
+      std::filesystem::path(flags["--bank-root"]) / flags["--bank"];
+  std::vector<std::string> targets;
+  wordy_witch::read_words(targets, bank_path / "targets.txt");
+  std::vector<std::string> guesses;
+  wordy_witch::read_words(guesses, bank_path / "common_guesses.txt");
+  int num_words = std::stoi(flags["--words"]);
+  targets.resize(std::min<int>(targets.size(), num_words));
+  guesses.resize(std::min<int>(guesses.size(), num_words));
+  if (targets.empty()) {
+    std::cerr << "Cannot load bank " << flags["--bank"] << std::endl;
+    return 1;
+  }
+  std::vector<std::string> words;
+  for (const std::vector<std::string>& list : {targets, guesses}) {
+    for (const std::string& word : list) {
+      words.push_back(wordy_witch::to_upper(word));
+    }
+  }
+
+  bool has_failed = false;
+  for (auto [word_size, error] : {
+           std::pair{4, check_word_size<4>(words, targets.size())},
+           std::pair{6, check_word_size<6>(words, targets.size())},
+           std::pair{7, check_word_size<7>(words, targets.size())},
+       }) {
+    if (error.has_value()) {
+      std::cerr << word_size << " letters: " << error.value() << std::endl;
+      has_failed = true;
+    }
+  }
+  return has_failed ? 1 : 0;
+}
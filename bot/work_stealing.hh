@@ -0,0 +1,196 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace wordy_witch {
+
+/* Tasks spawned by one search frame, which waits for all of them at once */
+struct task_group {
+  std::atomic<int> num_pending_tasks = 0;
+};
+
+struct work_stealing_task {
+  std::function<void()> run;
+  task_group* group;
+};
+
+struct work_stealing_queue {
+  std::mutex mutex;
+  std::deque<work_stealing_task> tasks;
+};
+
+/*
+  Every thread of the pool owns a queue: it pushes and pops its own tasks at
+  the back, and steals from the front of the others' queues when its own is
+  empty, which hands out the oldest and thus largest tasks first. A thread
+  waiting for a task group keeps running tasks meanwhile, so no thread ever
+  blocks on a search.
+*/
+struct work_stealing_pool {
+  std::vector<std::unique_ptr<work_stealing_queue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<int> num_queued_tasks = 0;
+  bool is_stopping = false;
+  std::mutex idle_mutex;
+  std::condition_variable idle_condition;
+  /* Queue 0 belongs to the thread inside `run_in_work_stealing_pool` */
+  std::mutex caller_mutex;
+
+  explicit work_stealing_pool(int num_threads);
+  ~work_stealing_pool();
+};
+
+static thread_local work_stealing_pool* current_work_stealing_pool = nullptr;
+static thread_local int current_work_stealing_queue_index = 0;
+
+/*
+  Whether tasks spawned by the calling thread may run on other threads;
+  otherwise `spawn_task` runs them on the spot
+*/
+bool is_in_work_stealing_pool() {
+  return current_work_stealing_pool != nullptr;
+}
+
+static bool run_one_queued_task(work_stealing_pool& pool, int queue_index) {
+  std::optional<work_stealing_task> task;
+  {
+    work_stealing_queue& queue = *pool.queues[queue_index];
+    std::lock_guard lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+  }
+  for (int i = 1; i < pool.queues.size() && !task.has_value(); i++) {
+    work_stealing_queue& queue =
+        *pool.queues[(queue_index + i) % pool.queues.size()];
+    std::lock_guard lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+  }
+  if (!task.has_value()) {
+    return false;
+  }
+  pool.num_queued_tasks.fetch_sub(1, std::memory_order_relaxed);
+  task->run();
+  task->group->num_pending_tasks.fetch_sub(1, std::memory_order_release);
+  return true;
+}
+
+work_stealing_pool::work_stealing_pool(int num_threads) {
+  for (int i = 0; i < std::max(num_threads, 1); i++) {
+    queues.push_back(std::make_unique<work_stealing_queue>());
+  }
+  for (int i = 1; i < queues.size(); i++) {
+    workers.emplace_back([this, i]() -> void {
+      current_work_stealing_pool = this;
+      current_work_stealing_queue_index = i;
+      while (true) {
+        if (run_one_queued_task(*this, i)) {
+          continue;
+        }
+        std::unique_lock lock(idle_mutex);
+        idle_condition.wait(lock, [this]() -> bool {
+          return is_stopping || num_queued_tasks.load() > 0;
+        });
+        if (is_stopping) {
+          return;
+        }
+      }
+    });
+  }
+}
+
+work_stealing_pool::~work_stealing_pool() {
+  {
+    std::lock_guard lock(idle_mutex);
+    is_stopping = true;
+  }
+  idle_condition.notify_all();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+/*
+  Runs `f` on the calling thread, with the tasks it spawns spread over the
+  threads of `pool`; one thread at a time may run in a given pool
+*/
+void run_in_work_stealing_pool(work_stealing_pool& pool,
+                               const std::function<void()>& f) {
+  std::lock_guard lock(pool.caller_mutex);
+  current_work_stealing_pool = &pool;
+  current_work_stealing_queue_index = 0;
+  f();
+  current_work_stealing_pool = nullptr;
+}
+
+void spawn_task(task_group& group, std::function<void()> run) {
+  if (!is_in_work_stealing_pool()) {
+    run();
+    return;
+  }
+  work_stealing_pool& pool = *current_work_stealing_pool;
+  group.num_pending_tasks.fetch_add(1, std::memory_order_relaxed);
+  {
+    work_stealing_queue& queue =
+        *pool.queues[current_work_stealing_queue_index];
+    std::lock_guard lock(queue.mutex);
+    queue.tasks.push_back({.run = std::move(run), .group = &group});
+  }
+  {
+    std::lock_guard lock(pool.idle_mutex);
+    pool.num_queued_tasks.fetch_add(1, std::memory_order_relaxed);
+  }
+  pool.idle_condition.notify_one();
+}
+
+void wait_for_tasks(task_group& group) {
+  while (group.num_pending_tasks.load(std::memory_order_acquire) > 0) {
+    if (!run_one_queued_task(*current_work_stealing_pool,
+                             current_work_stealing_queue_index)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+/*
+  A buffer that a frame keeps while it waits for tasks: the thread runs other
+  searches meanwhile, which must not reuse it. Buffers are recycled through a
+  free list per thread, since a frame never moves to another thread.
+*/
+template <typename buffer_type>
+struct recycled_buffer {
+  static thread_local std::vector<std::unique_ptr<buffer_type>> free_buffers;
+  std::unique_ptr<buffer_type> buffer;
+
+  recycled_buffer() {
+    if (free_buffers.empty()) {
+      buffer = std::make_unique_for_overwrite<buffer_type>();
+    } else {
+      buffer = std::move(free_buffers.back());
+      free_buffers.pop_back();
+    }
+  }
+  ~recycled_buffer() { free_buffers.push_back(std::move(buffer)); }
+  recycled_buffer(const recycled_buffer&) = delete;
+  recycled_buffer& operator=(const recycled_buffer&) = delete;
+
+  buffer_type& operator*() { return *buffer; }
+};
+
+template <typename buffer_type>
+thread_local std::vector<std::unique_ptr<buffer_type>>
+    recycled_buffer<buffer_type>::free_buffers;
+
+}  // namespace wordy_witch